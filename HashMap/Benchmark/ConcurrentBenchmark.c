@@ -0,0 +1,217 @@
+/**
+ * Throughput of the concurrent hash table against a hash_table behind one mutex,
+ * from 1 thread up to the given maximum, on a read-mostly and a write-heavy mix.
+ *
+ * Build from the HashMap directory with make concurrent_benchmark.
+ * Usage:
+ *   ./concurrent_benchmark [max_threads] [keys] [ops_per_thread]
+ */
+#include "../ConcurrentHashMap.h"
+#include "../HashMap.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/// @brief Percentage of writes of each mix.
+static const int write_percents[] = {5, 50};
+static const char *mix_names[] = {"read-mostly", "write-heavy"};
+
+/// @brief Shared state of one run.
+typedef struct BenchRun
+{
+    concurrent_hash_table *concurrent;
+    hash_table *locked;
+    pthread_mutex_t lock;
+    pthread_barrier_t barrier;
+    char **keys;
+    int keyCount;
+    long ops;
+    int writePercent;
+} bench_run;
+
+/// @brief Arguments of a worker thread.
+typedef struct BenchWorker
+{
+    bench_run *run;
+    unsigned long long seed;
+} bench_worker;
+
+/**
+ * Get the next pseudo random number of a xorshift state.
+ */
+static unsigned long long next_random(unsigned long long *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/**
+ * Get the current time in seconds.
+ */
+static double now_seconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Run the mix against the concurrent table.
+ */
+static void *concurrent_worker(void *arg)
+{
+    bench_worker *worker = arg;
+    bench_run *run = worker->run;
+    unsigned long long state = worker->seed;
+    int val = 0;
+
+    pthread_barrier_wait(&run->barrier);
+    for (long i = 0; i < run->ops; i++)
+    {
+        unsigned long long r = next_random(&state);
+        char *key = run->keys[(r >> 8) % run->keyCount];
+        if ((int)(r % 100) < run->writePercent)
+            set_concurrent_entry(run->concurrent, key, (int)i);
+        else
+            search_concurrent_hash_table(run->concurrent, key, &val);
+    }
+    return NULL;
+}
+
+/**
+ * Run the mix against the hash_table behind a single mutex.
+ */
+static void *locked_worker(void *arg)
+{
+    bench_worker *worker = arg;
+    bench_run *run = worker->run;
+    unsigned long long state = worker->seed;
+
+    pthread_barrier_wait(&run->barrier);
+    for (long i = 0; i < run->ops; i++)
+    {
+        unsigned long long r = next_random(&state);
+        char *key = run->keys[(r >> 8) % run->keyCount];
+        pthread_mutex_lock(&run->lock);
+        if ((int)(r % 100) < run->writePercent)
+            set_entry(run->locked, key, (int)i);
+        else
+            search_hash_table(run->locked, key);
+        pthread_mutex_unlock(&run->lock);
+    }
+    return NULL;
+}
+
+/**
+ * Run a mix with the given number of threads and return the throughput in operations per second.
+ */
+static double run_threads(bench_run *run, int threads, void *(*worker_fn)(void *))
+{
+    pthread_t *ids = malloc(threads * sizeof(pthread_t));
+    bench_worker *workers = malloc(threads * sizeof(bench_worker));
+    if (ids == NULL || workers == NULL)
+    {
+        free(ids);
+        free(workers);
+        return 0;
+    }
+
+    pthread_barrier_init(&run->barrier, NULL, threads + 1);
+    for (int i = 0; i < threads; i++)
+    {
+        workers[i].run = run;
+        workers[i].seed = 0x9E3779B97F4A7C15ULL * (i + 1);
+        pthread_create(&ids[i], NULL, worker_fn, &workers[i]);
+    }
+
+    // Start every thread at once.
+    pthread_barrier_wait(&run->barrier);
+    double start = now_seconds();
+    for (int i = 0; i < threads; i++)
+        pthread_join(ids[i], NULL);
+    double elapsed = now_seconds() - start;
+
+    pthread_barrier_destroy(&run->barrier);
+    free(ids);
+    free(workers);
+    return (double)run->ops * threads / elapsed;
+}
+
+int main(int argc, char **argv)
+{
+    int max_threads = argc > 1 ? atoi(argv[1]) : 8;
+    int key_count = argc > 2 ? atoi(argv[2]) : 1000000;
+    long ops = argc > 3 ? atol(argv[3]) : 1000000;
+    if (max_threads < 1 || key_count < 1 || ops < 1)
+    {
+        printf("Usage: %s [max_threads] [keys] [ops_per_thread]\n", argv[0]);
+        return 1;
+    }
+
+    // Build the key set and fill both tables with it.
+    char **keys = malloc(key_count * sizeof(char *));
+    if (keys == NULL)
+        return 1;
+    for (int i = 0; i < key_count; i++)
+    {
+        keys[i] = malloc(24);
+        if (keys[i] == NULL)
+            return 1;
+        snprintf(keys[i], 24, "key:%d", i);
+    }
+
+    printf("mix,table,threads,mops,speedup\n");
+    for (int m = 0; m < 2; m++)
+    {
+        bench_run run;
+        run.concurrent = create_concurrent_hash_table();
+        run.locked = create_hash_table();
+        if (run.concurrent == NULL || run.locked == NULL)
+            return 1;
+        pthread_mutex_init(&run.lock, NULL);
+        run.keys = keys;
+        run.keyCount = key_count;
+        run.ops = ops;
+        run.writePercent = write_percents[m];
+        for (int i = 0; i < key_count; i++)
+        {
+            set_concurrent_entry(run.concurrent, keys[i], i);
+            set_entry(run.locked, keys[i], i);
+        }
+
+        double concurrent_base = 0;
+        double locked_base = 0;
+        int threads = 1;
+        while (true)
+        {
+            double concurrent = run_threads(&run, threads, concurrent_worker);
+            double locked = run_threads(&run, threads, locked_worker);
+            if (threads == 1)
+            {
+                concurrent_base = concurrent;
+                locked_base = locked;
+            }
+            printf("%s,concurrent,%d,%.2f,%.2f\n", mix_names[m], threads, concurrent / 1e6, concurrent / concurrent_base);
+            printf("%s,mutex,%d,%.2f,%.2f\n", mix_names[m], threads, locked / 1e6, locked / locked_base);
+            fflush(stdout);
+
+            // Double the threads but always end on the requested maximum.
+            if (threads == max_threads)
+                break;
+            threads = threads * 2 > max_threads ? max_threads : threads * 2;
+        }
+
+        cleanup_concurrent_table(run.concurrent);
+        cleanup_table(run.locked);
+        pthread_mutex_destroy(&run.lock);
+    }
+
+    for (int i = 0; i < key_count; i++)
+        free(keys[i]);
+    free(keys);
+    return 0;
+}
\ No newline at end of file
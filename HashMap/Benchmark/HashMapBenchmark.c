@@ -0,0 +1,373 @@
+/**
+ * Benchmark of hash_table covering insert, hit lookup, miss lookup, update and a mixed workload,
+ * with uniform and Zipfian key choice, short, medium and long keys and table sizes from
+ * L1 resident to well beyond the last level cache.
+ *
+ * Every row reports the mean ns/op, latency percentiles and the peak RSS so far of the size.
+ * Each table size runs in its own child process, so the peak RSS of a row only covers that size.
+ * Latencies are sampled per group of BENCH_SAMPLE_OPS operations, so the timer cost stays
+ * out of the measurement, and divided back to a per operation value.
+ *
+ * Build from the HashMap directory with make hashmap_benchmark.
+ * Usage:
+ *   ./hashmap_benchmark [--max-size N] [--ops N] [--format csv|json]
+ */
+#include "../HashMap.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/// @brief Operations timed together for one latency sample.
+#define BENCH_SAMPLE_OPS 8
+
+/// @brief Skew of the Zipfian distribution.
+#define BENCH_ZIPF_SKEW 0.99
+
+typedef enum
+{
+    KEYS_SHORT,
+    KEYS_MEDIUM,
+    KEYS_LONG
+} key_length;
+
+typedef enum
+{
+    DIST_UNIFORM,
+    DIST_ZIPF
+} key_distribution;
+
+static const char *key_length_names[] = {"short", "medium", "long"};
+static const char *distribution_names[] = {"uniform", "zipf"};
+static const int table_sizes[] = {1 << 10, 1 << 14, 1 << 17, 1 << 20, 1 << 22, 1 << 24};
+
+/// @brief Result of one workload.
+typedef struct BenchResult
+{
+    const char *workload;
+    key_distribution dist;
+    key_length keys;
+    int size;
+    long ops;
+    double ns_per_op;
+    double p50;
+    double p90;
+    double p99;
+    double p999;
+    long peak_rss_kb;
+} bench_result;
+
+static bool json_output = false;
+
+/**
+ * Get the next pseudo random number of a xorshift state.
+ */
+static unsigned long long next_random(unsigned long long *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/**
+ * Get a monotonic timestamp in nanoseconds.
+ */
+static long long now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * Get the peak resident set size of the process in KB, the child of the running size.
+ */
+static long peak_rss_kb()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/**
+ * Build a unique key of the given length class.
+ * Long keys look like URLs, which is the usual worst case for string hashing.
+ */
+static char *make_key(key_length keys, const char *prefix, int i)
+{
+    char buffer[256];
+    unsigned long long scrambled = (unsigned long long)i * 0x9E3779B97F4A7C15ULL;
+    if (keys == KEYS_SHORT)
+        snprintf(buffer, sizeof(buffer), "%s%d", prefix, i);
+    else if (keys == KEYS_MEDIUM)
+        snprintf(buffer, sizeof(buffer), "%s:user:%d:session:%016llx", prefix, i, scrambled);
+    else
+        snprintf(buffer, sizeof(buffer),
+                 "https://%s.example.com/catalog/category-%d/products/item-%016llx/reviews?page=%d&sort=newest&lang=en-US&ref=%016llx",
+                 prefix, i % 97, scrambled, i, scrambled ^ 0xABCDEF);
+    return strdup(buffer);
+}
+
+/**
+ * Fill a sequence of key indexes in [0, n) with the given distribution.
+ * Zipfian ranks are spread over the keys, so hot keys don't share buckets by construction.
+ */
+static void make_sequence(int *sequence, long ops, int n, key_distribution dist, unsigned long long seed)
+{
+    unsigned long long state = seed;
+    if (dist == DIST_UNIFORM)
+    {
+        for (long i = 0; i < ops; i++)
+            sequence[i] = (int)(next_random(&state) % n);
+        return;
+    }
+
+    // Build the CDF once and sample by binary search.
+    double *cdf = malloc(n * sizeof(double));
+    if (cdf == NULL)
+        exit(1);
+    double sum = 0;
+    for (int i = 0; i < n; i++)
+    {
+        sum += 1.0 / pow(i + 1, BENCH_ZIPF_SKEW);
+        cdf[i] = sum;
+    }
+    for (long i = 0; i < ops; i++)
+    {
+        double u = (next_random(&state) >> 11) * (1.0 / 9007199254740992.0) * sum;
+        int low = 0;
+        int high = n - 1;
+        while (low < high)
+        {
+            int mid = low + (high - low) / 2;
+            if (cdf[mid] < u)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        sequence[i] = (int)(((unsigned long long)low * 2654435761ULL) % n);
+    }
+    free(cdf);
+}
+
+/**
+ * Compare two doubles for qsort.
+ */
+static int compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Sort the samples and fill the mean and percentiles of a result.
+ */
+static void summarize(bench_result *result, double *samples, long count, long long total_ns)
+{
+    qsort(samples, count, sizeof(double), compare_doubles);
+    result->ns_per_op = (double)total_ns / result->ops;
+    result->p50 = samples[(long)(count * 0.50)];
+    result->p90 = samples[(long)(count * 0.90)];
+    result->p99 = samples[(long)(count * 0.99)];
+    result->p999 = samples[(long)(count * 0.999)];
+    result->peak_rss_kb = peak_rss_kb();
+}
+
+/**
+ * Print a result as a CSV row or a JSON line.
+ */
+static void print_result(const bench_result *result)
+{
+    if (json_output)
+        printf("{\"workload\":\"%s\",\"distribution\":\"%s\",\"keys\":\"%s\",\"size\":%d,\"ops\":%ld,"
+               "\"ns_per_op\":%.2f,\"p50\":%.2f,\"p90\":%.2f,\"p99\":%.2f,\"p999\":%.2f,\"peak_rss_kb\":%ld}\n",
+               result->workload, distribution_names[result->dist], key_length_names[result->keys], result->size,
+               result->ops, result->ns_per_op, result->p50, result->p90, result->p99, result->p999,
+               result->peak_rss_kb);
+    else
+        printf("%s,%s,%s,%d,%ld,%.2f,%.2f,%.2f,%.2f,%.2f,%ld\n", result->workload, distribution_names[result->dist],
+               key_length_names[result->keys], result->size, result->ops, result->ns_per_op, result->p50,
+               result->p90, result->p99, result->p999, result->peak_rss_kb);
+    fflush(stdout);
+}
+
+/// @brief Operation of a timed loop.
+typedef enum
+{
+    OP_INSERT,
+    OP_HIT,
+    OP_MISS,
+    OP_UPDATE,
+    OP_MIXED
+} bench_op;
+
+/**
+ * Run ops operations, timing them in groups, and print the result.
+ * The mixed workload is 70% hits, 20% updates and 10% misses.
+ */
+static void run_workload(const char *name, bench_op op, hash_table *table, char **keys, char **misses,
+                         const int *sequence, long ops, key_distribution dist, key_length key_class, int size)
+{
+    long sample_count = (ops + BENCH_SAMPLE_OPS - 1) / BENCH_SAMPLE_OPS;
+    double *samples = malloc(sample_count * sizeof(double));
+    if (samples == NULL)
+        exit(1);
+
+    volatile long sink = 0;
+    long long total = 0;
+    for (long s = 0; s < sample_count; s++)
+    {
+        long first = s * BENCH_SAMPLE_OPS;
+        long last = first + BENCH_SAMPLE_OPS < ops ? first + BENCH_SAMPLE_OPS : ops;
+        long long start = now_ns();
+        for (long i = first; i < last; i++)
+        {
+            int k = sequence[i];
+            dll_set_node *node = NULL;
+            switch (op)
+            {
+            case OP_INSERT:
+                set_entry(table, keys[i], (int)i);
+                break;
+            case OP_HIT:
+                node = search_hash_table(table, keys[k]);
+                break;
+            case OP_MISS:
+                node = search_hash_table(table, misses[k]);
+                break;
+            case OP_UPDATE:
+                set_entry(table, keys[k], (int)i);
+                break;
+            case OP_MIXED:
+                if (i % 10 < 7)
+                    node = search_hash_table(table, keys[k]);
+                else if (i % 10 < 9)
+                    set_entry(table, keys[k], (int)i);
+                else
+                    node = search_hash_table(table, misses[k]);
+                break;
+            }
+            sink += node != NULL;
+        }
+        long long elapsed = now_ns() - start;
+        total += elapsed;
+        samples[s] = (double)elapsed / (last - first);
+    }
+
+    bench_result result = {name, dist, key_class, size, ops, 0, 0, 0, 0, 0, 0};
+    summarize(&result, samples, sample_count, total);
+    print_result(&result);
+    free(samples);
+}
+
+/**
+ * Run every workload for one key length and table size.
+ */
+static void run_size(key_length key_class, int size, long ops)
+{
+    char **keys = malloc(size * sizeof(char *));
+    char **misses = malloc(size * sizeof(char *));
+    int *sequence = calloc(ops > size ? ops : size, sizeof(int));
+    if (keys == NULL || misses == NULL || sequence == NULL)
+        exit(1);
+    for (int i = 0; i < size; i++)
+    {
+        keys[i] = make_key(key_class, "hit", i);
+        misses[i] = make_key(key_class, "miss", i);
+        if (keys[i] == NULL || misses[i] == NULL)
+            exit(1);
+    }
+
+    // Insert every key into a new table, this is the table the other workloads use.
+    hash_table *table = create_hash_table();
+    if (table == NULL)
+        exit(1);
+    run_workload("insert", OP_INSERT, table, keys, misses, sequence, size, DIST_UNIFORM, key_class, size);
+
+    for (int d = DIST_UNIFORM; d <= DIST_ZIPF; d++)
+    {
+        make_sequence(sequence, ops, size, (key_distribution)d, 0x2545F4914F6CDD1DULL + d);
+        run_workload("hit", OP_HIT, table, keys, misses, sequence, ops, (key_distribution)d, key_class, size);
+        run_workload("miss", OP_MISS, table, keys, misses, sequence, ops, (key_distribution)d, key_class, size);
+        run_workload("update", OP_UPDATE, table, keys, misses, sequence, ops, (key_distribution)d, key_class, size);
+        run_workload("mixed", OP_MIXED, table, keys, misses, sequence, ops, (key_distribution)d, key_class, size);
+    }
+
+    cleanup_table(table);
+    for (int i = 0; i < size; i++)
+    {
+        free(keys[i]);
+        free(misses[i]);
+    }
+    free(keys);
+    free(misses);
+    free(sequence);
+}
+
+/**
+ * Run one size in a child process so its peak RSS starts from a small process.
+ * Runs the size inline if the fork fails. Returns false if the child failed.
+ */
+static bool run_size_isolated(key_length key_class, int size, long ops)
+{
+    fflush(stdout);
+    pid_t child = fork();
+    if (child == 0)
+    {
+        run_size(key_class, size, ops);
+        exit(0);
+    }
+    if (child < 0)
+    {
+        run_size(key_class, size, ops);
+        return true;
+    }
+
+    int status = 0;
+    if (waitpid(child, &status, 0) != child)
+        return false;
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int main(int argc, char **argv)
+{
+    long max_size = 1 << 22;
+    long ops = 1000000;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--max-size") == 0 && i + 1 < argc)
+            max_size = atol(argv[++i]);
+        else if (strcmp(argv[i], "--ops") == 0 && i + 1 < argc)
+            ops = atol(argv[++i]);
+        else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc)
+            json_output = strcmp(argv[++i], "json") == 0;
+        else
+        {
+            printf("Usage: %s [--max-size N] [--ops N] [--format csv|json]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (ops < 1)
+        return 1;
+
+    if (!json_output)
+        printf("workload,distribution,keys,size,ops,ns_per_op,p50,p90,p99,p999,peak_rss_kb\n");
+    for (int k = KEYS_SHORT; k <= KEYS_LONG; k++)
+    {
+        for (size_t s = 0; s < sizeof(table_sizes) / sizeof(table_sizes[0]); s++)
+        {
+            if (table_sizes[s] > max_size)
+                break;
+            if (!run_size_isolated((key_length)k, table_sizes[s], ops))
+                return 1;
+        }
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,319 @@
+/**
+ * Word count over a Zipfian text, the usual multi threaded aggregation job.
+ * Each thread tokenizes its slice of the text and counts every word, into a hash_table
+ * behind one mutex, into the concurrent table or into its own shards merged at the end.
+ * The sharded time includes the merge. Every run checks the total count of words.
+ *
+ * Build from the HashMap directory with make wordcount_benchmark.
+ * Usage:
+ *   ./wordcount_benchmark [max_threads] [words] [vocabulary]
+ */
+#include "../ConcurrentHashMap.h"
+#include "../HashMap.h"
+#include "../ShardedHashMap.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/// @brief Skew of the word frequencies, close to natural text.
+#define WORD_ZIPF_SKEW 1.0
+
+/// @brief Longest word of the vocabulary, NUL included.
+#define WORD_MAX_LENGTH 16
+
+typedef enum
+{
+    COUNT_LOCKED,
+    COUNT_CONCURRENT,
+    COUNT_SHARDED
+} count_mode;
+
+static const char *mode_names[] = {"locked", "concurrent", "sharded"};
+
+/// @brief Shared state of one run.
+typedef struct CountRun
+{
+    count_mode mode;
+    const char *text;
+    size_t length;
+    int threads;
+    hash_table *locked;
+    pthread_mutex_t lock;
+    concurrent_hash_table *concurrent;
+    sharded_hash_table *sharded;
+    pthread_barrier_t barrier;
+} count_run;
+
+/// @brief Arguments of a worker thread.
+typedef struct CountWorker
+{
+    count_run *run;
+    int index;
+} count_worker;
+
+/**
+ * Get the next pseudo random number of a xorshift state.
+ */
+static unsigned long long next_random(unsigned long long *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/**
+ * Get the current time in seconds.
+ */
+static double now_seconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Build a text of words separated by single spaces.
+ * Word ranks follow a Zipfian distribution over a vocabulary of random lowercase words.
+ */
+static char *make_text(long words, int vocabulary, size_t *length)
+{
+    char (*vocab)[WORD_MAX_LENGTH] = malloc(vocabulary * sizeof(*vocab));
+    double *cdf = malloc(vocabulary * sizeof(double));
+    char *text = malloc(words * WORD_MAX_LENGTH + 1);
+    if (vocab == NULL || cdf == NULL || text == NULL)
+        exit(1);
+
+    unsigned long long state = 0x2545F4914F6CDD1DULL;
+    double sum = 0;
+    for (int i = 0; i < vocabulary; i++)
+    {
+        // Append the rank in base 26, so every word is unique.
+        int len = 2 + (int)(next_random(&state) % 7);
+        for (int c = 0; c < len; c++)
+            vocab[i][c] = (char)('a' + next_random(&state) % 26);
+        for (int rank = i; ; rank /= 26)
+        {
+            vocab[i][len++] = (char)('a' + rank % 26);
+            if (rank < 26)
+                break;
+        }
+        vocab[i][len] = '\0';
+        sum += 1.0 / pow(i + 1, WORD_ZIPF_SKEW);
+        cdf[i] = sum;
+    }
+
+    size_t used = 0;
+    for (long w = 0; w < words; w++)
+    {
+        double u = (next_random(&state) >> 11) * (1.0 / 9007199254740992.0) * sum;
+        int low = 0;
+        int high = vocabulary - 1;
+        while (low < high)
+        {
+            int mid = low + (high - low) / 2;
+            if (cdf[mid] < u)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        size_t len = strlen(vocab[low]);
+        memcpy(text + used, vocab[low], len);
+        used += len;
+        text[used++] = ' ';
+    }
+    text[used] = '\0';
+    *length = used;
+    free(vocab);
+    free(cdf);
+    return text;
+}
+
+/**
+ * Count the word in buffer on the table of the run.
+ */
+static void count_word(count_run *run, int index, char *word)
+{
+    switch (run->mode)
+    {
+    case COUNT_LOCKED:
+        pthread_mutex_lock(&run->lock);
+        add_to_entry(run->locked, word, 1);
+        pthread_mutex_unlock(&run->lock);
+        break;
+    case COUNT_CONCURRENT:
+        concurrent_add_entry(run->concurrent, word, 1, NULL);
+        break;
+    case COUNT_SHARDED:
+        sharded_add(run->sharded, index, word, 1);
+        break;
+    }
+}
+
+/**
+ * Tokenize the slice of the text of a worker and count its words.
+ * A slice starts after the first space at or past its offset, so no word is split or counted twice.
+ */
+static void *count_worker_words(void *arg)
+{
+    count_worker *worker = arg;
+    count_run *run = worker->run;
+    size_t first = run->length * worker->index / run->threads;
+    size_t end = run->length * (worker->index + 1) / run->threads;
+    while (first > 0 && first < run->length && run->text[first - 1] != ' ')
+        first++;
+    while (end < run->length && run->text[end - 1] != ' ')
+        end++;
+
+    pthread_barrier_wait(&run->barrier);
+    char word[WORD_MAX_LENGTH];
+    int len = 0;
+    for (size_t i = first; i < end; i++)
+    {
+        if (run->text[i] != ' ')
+        {
+            word[len++] = run->text[i];
+            continue;
+        }
+        word[len] = '\0';
+        count_word(run, worker->index, word);
+        len = 0;
+    }
+    return NULL;
+}
+
+/**
+ * Sum the counts of a table to check the run.
+ */
+static long long total_of_table(hash_table *table)
+{
+    long long total = 0;
+    hash_table_cursor cursor;
+    hash_table_cursor_begin(table, &cursor);
+    dll_set_node *node = NULL;
+    while ((node = hash_table_cursor_next(&cursor)) != NULL)
+        total += node->val;
+    hash_table_cursor_close(&cursor);
+    return total;
+}
+
+/**
+ * Count the text with the given mode and threads.
+ * Returns the elapsed seconds, sets the total and distinct counts to check the run.
+ */
+static double run_count(count_run *run, int threads, long long *total, int *distinct)
+{
+    pthread_t *ids = malloc(threads * sizeof(pthread_t));
+    count_worker *workers = malloc(threads * sizeof(count_worker));
+    if (ids == NULL || workers == NULL)
+        exit(1);
+
+    run->threads = threads;
+    run->locked = create_hash_table();
+    pthread_mutex_init(&run->lock, NULL);
+    run->concurrent = create_concurrent_hash_table();
+    run->sharded = create_sharded_hash_table(threads, threads * 4);
+    if (run->locked == NULL || run->concurrent == NULL || run->sharded == NULL)
+        exit(1);
+
+    pthread_barrier_init(&run->barrier, NULL, threads + 1);
+    for (int i = 0; i < threads; i++)
+    {
+        workers[i].run = run;
+        workers[i].index = i;
+        pthread_create(&ids[i], NULL, count_worker_words, &workers[i]);
+    }
+
+    // Start every thread at once.
+    pthread_barrier_wait(&run->barrier);
+    double start = now_seconds();
+    for (int i = 0; i < threads; i++)
+        pthread_join(ids[i], NULL);
+    if (run->mode == COUNT_SHARDED)
+        merge_sharded_hash_table(run->sharded, threads);
+    double elapsed = now_seconds() - start;
+
+    *total = 0;
+    if (run->mode == COUNT_LOCKED)
+    {
+        *total = total_of_table(run->locked);
+        *distinct = run->locked->elementCount;
+    }
+    else if (run->mode == COUNT_CONCURRENT)
+    {
+        // The concurrent table has no iteration, check the count of distinct words only.
+        *total = -1;
+        *distinct = concurrent_element_count(run->concurrent);
+    }
+    else
+    {
+        for (int p = 0; p < run->sharded->partitions; p++)
+            *total += total_of_table(run->sharded->merged[p]);
+        *distinct = sharded_element_count(run->sharded);
+    }
+
+    pthread_barrier_destroy(&run->barrier);
+    pthread_mutex_destroy(&run->lock);
+    cleanup_table(run->locked);
+    cleanup_concurrent_table(run->concurrent);
+    cleanup_sharded_hash_table(run->sharded);
+    free(ids);
+    free(workers);
+    return elapsed;
+}
+
+int main(int argc, char **argv)
+{
+    int max_threads = argc > 1 ? atoi(argv[1]) : 8;
+    long words = argc > 2 ? atol(argv[2]) : 10000000;
+    int vocabulary = argc > 3 ? atoi(argv[3]) : 500000;
+    if (max_threads < 1 || words < 1 || vocabulary < 1)
+    {
+        printf("Usage: %s [max_threads] [words] [vocabulary]\n", argv[0]);
+        return 1;
+    }
+
+    size_t length = 0;
+    char *text = make_text(words, vocabulary, &length);
+
+    printf("table,threads,words,seconds,mwords_per_s,speedup,distinct\n");
+    int expected_distinct = -1;
+    for (int m = COUNT_LOCKED; m <= COUNT_SHARDED; m++)
+    {
+        count_run run;
+        run.mode = (count_mode)m;
+        run.text = text;
+        run.length = length;
+
+        double base = 0;
+        int threads = 1;
+        while (true)
+        {
+            long long total = 0;
+            int distinct = 0;
+            double seconds = run_count(&run, threads, &total, &distinct);
+            if (expected_distinct < 0)
+                expected_distinct = distinct;
+            if ((total >= 0 && total != words) || distinct != expected_distinct)
+            {
+                printf("%s with %d threads counted %lld words, %d distinct\n", mode_names[m], threads, total, distinct);
+                return 1;
+            }
+            if (threads == 1)
+                base = seconds;
+            printf("%s,%d,%ld,%.3f,%.2f,%.2f,%d\n", mode_names[m], threads, words, seconds, words / seconds / 1e6,
+                   base / seconds, distinct);
+            fflush(stdout);
+
+            if (threads == max_threads)
+                break;
+            threads = threads * 2 < max_threads ? threads * 2 : max_threads;
+        }
+    }
+    free(text);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "BloomFilter.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// @brief Odd multipliers that pick the bit of each word, one per word.
+static const uint32_t bloom_salts[BLOOM_BLOCK_WORDS] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                                        0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+/**
+ * Build the mask of the bit a key sets on each word of its block.
+ */
+static void bloom_mask(uint64_t hash, uint64_t *mask)
+{
+    uint32_t key = (uint32_t)hash;
+    for (int i = 0; i < BLOOM_BLOCK_WORDS; i++)
+        mask[i] = 1ULL << ((key * bloom_salts[i]) >> 26);
+}
+
+/**
+ * Initialize a empty filter for capacity keys at the given false positive rate.
+ * Blocked filters lose some accuracy against the classic one, so the classic
+ * bit count is padded by a fifth and rounded up to a power of two of blocks.
+ * Returns false if the blocks couldn't be allocated.
+ */
+bool init_bloom_filter(bloom_filter *filter, size_t capacity, double fp_rate)
+{
+    if (fp_rate <= 0 || fp_rate >= 1)
+        fp_rate = 0.01;
+    if (capacity == 0)
+        capacity = 1;
+
+    double ln2 = log(2.0);
+    double bits = -(double)capacity * log(fp_rate) / (ln2 * ln2) * 1.2;
+    uint64_t blocks = 1;
+    while ((double)blocks * sizeof(bloom_block) * 8 < bits)
+        blocks *= 2;
+
+    filter->blocks = aligned_alloc(sizeof(bloom_block), blocks * sizeof(bloom_block));
+    if (filter->blocks == NULL)
+        return false;
+    filter->block_mask = blocks - 1;
+    filter->capacity = capacity;
+    filter->fp_rate = fp_rate;
+    filter->misses_avoided = 0;
+    clear_bloom_filter(filter);
+    return true;
+}
+
+/**
+ * Get the block a hash maps to, to prefetch it before a query.
+ */
+const bloom_block *bloom_block_of(const bloom_filter *filter, uint64_t hash)
+{
+    return &filter->blocks[(hash >> 32) & filter->block_mask];
+}
+
+/**
+ * Add a hash to the filter.
+ */
+void bloom_add(bloom_filter *filter, uint64_t hash)
+{
+    uint64_t mask[BLOOM_BLOCK_WORDS];
+    bloom_mask(hash, mask);
+    bloom_block *block = &filter->blocks[(hash >> 32) & filter->block_mask];
+    for (int i = 0; i < BLOOM_BLOCK_WORDS; i++)
+        block->words[i] |= mask[i];
+}
+
+/**
+ * Check if a hash might be on the filter, false means it was never added.
+ * Every word is tested without a early exit, which the compiler turns into vector code.
+ */
+bool bloom_may_contain(const bloom_filter *filter, uint64_t hash)
+{
+    uint64_t mask[BLOOM_BLOCK_WORDS];
+    bloom_mask(hash, mask);
+    const bloom_block *block = bloom_block_of(filter, hash);
+    uint64_t missing = 0;
+    for (int i = 0; i < BLOOM_BLOCK_WORDS; i++)
+        missing |= mask[i] & ~block->words[i];
+    return missing == 0;
+}
+
+/**
+ * Clear every bit of the filter.
+ */
+void clear_bloom_filter(bloom_filter *filter)
+{
+    memset(filter->blocks, 0, (filter->block_mask + 1) * sizeof(bloom_block));
+}
+
+/**
+ * Get the bytes taken by the blocks of the filter.
+ */
+size_t bloom_filter_bytes(const bloom_filter *filter)
+{
+    return (filter->block_mask + 1) * sizeof(bloom_block);
+}
+
+/**
+ * Free the blocks of the filter.
+ */
+void cleanup_bloom_filter(bloom_filter *filter)
+{
+    free(filter->blocks);
+    filter->blocks = NULL;
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#ifndef BLOOM_FILTER
+#define BLOOM_FILTER
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// @brief Words of a block, a key sets one bit on each.
+#define BLOOM_BLOCK_WORDS 8
+
+/// @brief One cache line of the filter.
+typedef struct BloomBlock
+{
+    uint64_t words[BLOOM_BLOCK_WORDS];
+} __attribute__((aligned(64))) bloom_block;
+
+/// @brief Blocked Bloom filter over already computed 64 bit hashes.
+/// The high half of the hash picks a block and the low half one bit of each of its words,
+/// so a query touches a single cache line and its 8 tests don't depend on each other.
+/// Bits can't be cleared, removed keys stay until the filter is rebuilt.
+typedef struct BloomFilter
+{
+    bloom_block *blocks;
+    uint64_t block_mask;
+    size_t capacity;
+    double fp_rate;
+    unsigned long long misses_avoided;
+} bloom_filter;
+
+bool init_bloom_filter(bloom_filter *filter, size_t capacity, double fp_rate);
+void bloom_add(bloom_filter *filter, uint64_t hash);
+bool bloom_may_contain(const bloom_filter *filter, uint64_t hash);
+const bloom_block *bloom_block_of(const bloom_filter *filter, uint64_t hash);
+void clear_bloom_filter(bloom_filter *filter);
+size_t bloom_filter_bytes(const bloom_filter *filter);
+void cleanup_bloom_filter(bloom_filter *filter);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,197 @@
+#include "ChainTree.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Order two entries by hash and then by key.
+ */
+static int compare_entry(const char *key, uint64_t hash, const dll_set_node *entry)
+{
+    if (hash != entry->hash)
+        return hash < entry->hash ? -1 : 1;
+    return strcmp(key, entry->key);
+}
+
+/**
+ * Get the height of a node, 0 for a empty tree.
+ */
+static int tree_height(chain_tree_node *node)
+{
+    return node != NULL ? node->height : 0;
+}
+
+/**
+ * Recompute the height of a node from its children.
+ */
+static void update_height(chain_tree_node *node)
+{
+    int left = tree_height(node->left);
+    int right = tree_height(node->right);
+    node->height = 1 + (left > right ? left : right);
+}
+
+static chain_tree_node *rotate_right(chain_tree_node *node)
+{
+    chain_tree_node *left = node->left;
+    node->left = left->right;
+    left->right = node;
+    update_height(node);
+    update_height(left);
+    return left;
+}
+
+static chain_tree_node *rotate_left(chain_tree_node *node)
+{
+    chain_tree_node *right = node->right;
+    node->right = right->left;
+    right->left = node;
+    update_height(node);
+    update_height(right);
+    return right;
+}
+
+/**
+ * Restore the AVL balance of a node whose subtrees differ by at most two.
+ */
+static chain_tree_node *rebalance(chain_tree_node *node)
+{
+    update_height(node);
+    int balance = tree_height(node->left) - tree_height(node->right);
+    if (balance > 1)
+    {
+        if (tree_height(node->left->left) < tree_height(node->left->right))
+            node->left = rotate_left(node->left);
+        return rotate_right(node);
+    }
+    if (balance < -1)
+    {
+        if (tree_height(node->right->right) < tree_height(node->right->left))
+            node->right = rotate_right(node->right);
+        return rotate_left(node);
+    }
+    return node;
+}
+
+static chain_tree_node *insert_node(chain_tree_node *node, chain_tree_node *new_node)
+{
+    if (node == NULL)
+        return new_node;
+
+    dll_set_node *entry = new_node->entry;
+    if (compare_entry(entry->key, entry->hash, node->entry) < 0)
+        node->left = insert_node(node->left, new_node);
+    else
+        node->right = insert_node(node->right, new_node);
+    return rebalance(node);
+}
+
+/**
+ * Index a entry, the key must not be on the tree already.
+ * Returns false if the tree node couldn't be allocated.
+ */
+bool chain_tree_insert(chain_tree_node **root, dll_set_node *entry)
+{
+    chain_tree_node *new_node = malloc(sizeof(chain_tree_node));
+    if (new_node == NULL)
+        return false;
+    new_node->entry = entry;
+    new_node->left = NULL;
+    new_node->right = NULL;
+    new_node->height = 1;
+    *root = insert_node(*root, new_node);
+    return true;
+}
+
+/**
+ * Unlink the smallest node of a subtree, returned on min.
+ */
+static chain_tree_node *remove_min(chain_tree_node *node, chain_tree_node **min)
+{
+    if (node->left == NULL)
+    {
+        *min = node;
+        return node->right;
+    }
+    node->left = remove_min(node->left, min);
+    return rebalance(node);
+}
+
+static chain_tree_node *remove_node(chain_tree_node *node, dll_set_node *entry)
+{
+    if (node == NULL)
+        return NULL;
+
+    int cmp = compare_entry(entry->key, entry->hash, node->entry);
+    if (cmp < 0)
+        node->left = remove_node(node->left, entry);
+    else if (cmp > 0)
+        node->right = remove_node(node->right, entry);
+    else
+    {
+        // Replace the node by its successor, or by its only child.
+        chain_tree_node *replacement = node->left;
+        if (node->right != NULL)
+        {
+            node->right = remove_min(node->right, &replacement);
+            replacement->left = node->left;
+            replacement->right = node->right;
+        }
+        free(node);
+        return replacement != NULL ? rebalance(replacement) : NULL;
+    }
+    return rebalance(node);
+}
+
+/**
+ * Drop a entry from the index.
+ */
+void chain_tree_remove(chain_tree_node **root, dll_set_node *entry)
+{
+    *root = remove_node(*root, entry);
+}
+
+/**
+ * Search for a key, might return NULL if not found.
+ */
+dll_set_node *chain_tree_find(chain_tree_node *root, const char *key, uint64_t hash)
+{
+    while (root != NULL)
+    {
+        int cmp = compare_entry(key, hash, root->entry);
+        if (cmp == 0)
+            return root->entry;
+        root = cmp < 0 ? root->left : root->right;
+    }
+    return NULL;
+}
+
+#ifdef HASH_MAP_STATS
+/**
+ * Same as chain_tree_find, visited receives the count of tree nodes looked at.
+ */
+dll_set_node *chain_tree_find_counted(chain_tree_node *root, const char *key, uint64_t hash, int *visited)
+{
+    *visited = 0;
+    while (root != NULL)
+    {
+        (*visited)++;
+        int cmp = compare_entry(key, hash, root->entry);
+        if (cmp == 0)
+            return root->entry;
+        root = cmp < 0 ? root->left : root->right;
+    }
+    return NULL;
+}
+#endif
+
+/**
+ * Free every node of the index, the entries are left untouched.
+ */
+void cleanup_chain_tree(chain_tree_node *root)
+{
+    if (root == NULL)
+        return;
+    cleanup_chain_tree(root->left);
+    cleanup_chain_tree(root->right);
+    free(root);
+}
\ No newline at end of file
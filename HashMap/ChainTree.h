@@ -0,0 +1,25 @@
+#ifndef CHAIN_TREE
+#define CHAIN_TREE
+#include <stdbool.h>
+#include <stdint.h>
+#include "DoublyLinkedList.h"
+
+/// @brief Node of a AVL index over the entries of a long bucket chain.
+/// Entries are ordered by their cached hash and then by key, the chain itself is left as it is.
+typedef struct ChainTreeNode
+{
+    dll_set_node *entry;
+    struct ChainTreeNode *left;
+    struct ChainTreeNode *right;
+    int height;
+} chain_tree_node;
+
+bool chain_tree_insert(chain_tree_node **root, dll_set_node *entry);
+void chain_tree_remove(chain_tree_node **root, dll_set_node *entry);
+dll_set_node *chain_tree_find(chain_tree_node *root, const char *key, uint64_t hash);
+#ifdef HASH_MAP_STATS
+dll_set_node *chain_tree_find_counted(chain_tree_node *root, const char *key, uint64_t hash, int *visited);
+#endif
+void cleanup_chain_tree(chain_tree_node *root);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,397 @@
+#include "ConcurrentHashMap.h"
+#include <stdlib.h>
+#include <string.h>
+
+/// @brief Initial number of buckets, never below the number of stripes.
+#define CONCURRENT_INITIAL_SIZE 64
+
+/**
+ * Allocate an array of empty buckets.
+ */
+static concurrent_buckets *allocate_concurrent_buckets(int size)
+{
+    concurrent_buckets *buckets = malloc(sizeof(concurrent_buckets) + size * sizeof(concurrent_node *));
+    if (buckets == NULL)
+        return NULL;
+    buckets->size = size;
+    for (int i = 0; i < size; i++)
+        atomic_init(&buckets->heads[i], NULL);
+    return buckets;
+}
+
+/**
+ * Allocate a node with a copy of the key.
+ */
+static concurrent_node *create_concurrent_node(const char *key, size_t len, uint64_t hash, int val)
+{
+    concurrent_node *node = malloc(sizeof(concurrent_node) + len + 1);
+    if (node == NULL)
+        return NULL;
+    atomic_init(&node->next, NULL);
+    node->retired_next = NULL;
+    node->hash = hash;
+    atomic_init(&node->val, val);
+    memcpy(node->key, key, len + 1);
+    return node;
+}
+
+/**
+ * Free every node of a chain.
+ */
+static void free_concurrent_chain(concurrent_node *node)
+{
+    concurrent_node *temp = NULL;
+    while (node != NULL)
+    {
+        temp = node;
+        node = atomic_load_explicit(&node->next, memory_order_relaxed);
+        free(temp);
+    }
+}
+
+/**
+ * Free every node of a bucket array and the array itself.
+ */
+static void free_concurrent_buckets(concurrent_buckets *buckets)
+{
+    for (int i = 0; i < buckets->size; i++)
+        free_concurrent_chain(atomic_load_explicit(&buckets->heads[i], memory_order_relaxed));
+    free(buckets);
+}
+
+/**
+ * Get the stripe that guards the buckets of a hash.
+ */
+static concurrent_stripe *stripe_of(concurrent_hash_table *table, uint64_t hash)
+{
+    return &table->stripes[hash & (CONCURRENT_STRIPES - 1)];
+}
+
+/**
+ * Create and return a concurrent hash table.
+ */
+concurrent_hash_table *create_concurrent_hash_table()
+{
+    concurrent_hash_table *new_table = malloc(sizeof(concurrent_hash_table));
+    if (new_table == NULL)
+        return NULL;
+
+    concurrent_buckets *buckets = allocate_concurrent_buckets(CONCURRENT_INITIAL_SIZE);
+    if (buckets == NULL || !init_epoch_domain(&new_table->epoch))
+    {
+        free(buckets);
+        free(new_table);
+        return NULL;
+    }
+    atomic_init(&new_table->buckets, buckets);
+
+    for (int i = 0; i < CONCURRENT_STRIPES; i++)
+    {
+        pthread_mutex_init(&new_table->stripes[i].lock, NULL);
+        new_table->stripes[i].elementCount = 0;
+    }
+    pthread_mutex_init(&new_table->resize_lock, NULL);
+    pthread_mutex_init(&new_table->retire_lock, NULL);
+    new_table->retired = NULL;
+    new_table->retiredCount = 0;
+    new_table->hash = hash_bytes_words;
+    return new_table;
+}
+
+/**
+ * Cleanup the table, no other thread may be using it.
+ */
+void cleanup_concurrent_table(concurrent_hash_table *table)
+{
+    if (table == NULL)
+        return;
+
+    free_concurrent_buckets(atomic_load_explicit(&table->buckets, memory_order_relaxed));
+    concurrent_node *node = table->retired;
+    concurrent_node *temp = NULL;
+    while (node != NULL)
+    {
+        temp = node;
+        node = node->retired_next;
+        free(temp);
+    }
+
+    for (int i = 0; i < CONCURRENT_STRIPES; i++)
+        pthread_mutex_destroy(&table->stripes[i].lock);
+    pthread_mutex_destroy(&table->resize_lock);
+    pthread_mutex_destroy(&table->retire_lock);
+    cleanup_epoch_domain(&table->epoch);
+    free(table);
+}
+
+/**
+ * Search for a key and copy its value.
+ * Takes no lock, returns false if the key isn't on the table.
+ */
+bool search_concurrent_hash_table(concurrent_hash_table *table, char *key, int *val)
+{
+    if (table == NULL || key == NULL)
+        return false;
+
+    uint64_t hash = table->hash(key, strlen(key));
+    bool found = false;
+
+    // Nothing read inside the section is freed until it ends.
+    int token = epoch_enter(&table->epoch);
+    concurrent_buckets *buckets = atomic_load_explicit(&table->buckets, memory_order_acquire);
+    concurrent_node *node = atomic_load_explicit(&buckets->heads[hash & (buckets->size - 1)], memory_order_acquire);
+    while (node != NULL)
+    {
+        if (node->hash == hash && strcmp(node->key, key) == 0)
+        {
+            if (val != NULL)
+                *val = atomic_load_explicit(&node->val, memory_order_relaxed);
+            found = true;
+            break;
+        }
+        node = atomic_load_explicit(&node->next, memory_order_acquire);
+    }
+    epoch_exit(&table->epoch, token);
+    return found;
+}
+
+/**
+ * Check if a stripe holds more than its share of 75% of the size.
+ * The stripe lock must be held.
+ */
+static bool stripe_over_load(concurrent_stripe *stripe, concurrent_buckets *buckets)
+{
+    return stripe->elementCount * CONCURRENT_STRIPES > buckets->size / 4 * 3;
+}
+
+/**
+ * Grow the bucket array to new_size, or double it if trigger is over its load.
+ * Every stripe is locked while the nodes are copied to the new array, readers keep
+ * using the old one until it's published and the old nodes are freed after a grace period.
+ * The array never shrinks, so a grow that lost the race to a bigger one does nothing.
+ */
+static void resize_buckets(concurrent_hash_table *table, int new_size, concurrent_stripe *trigger)
+{
+    pthread_mutex_lock(&table->resize_lock);
+    for (int i = 0; i < CONCURRENT_STRIPES; i++)
+        pthread_mutex_lock(&table->stripes[i].lock);
+
+    // Decide under the locks, another thread may have already grown the table.
+    concurrent_buckets *old_buckets = atomic_load_explicit(&table->buckets, memory_order_relaxed);
+    int size = old_buckets->size;
+    if (trigger == NULL)
+    {
+        while (size < new_size)
+            size *= 2;
+    }
+    else if (stripe_over_load(trigger, old_buckets))
+        size *= 2;
+
+    concurrent_buckets *new_buckets = NULL;
+    if (old_buckets->size < size)
+        new_buckets = allocate_concurrent_buckets(size);
+
+    // Copy each node, the old chains must stay intact for the readers still on them.
+    for (int i = 0; new_buckets != NULL && i < old_buckets->size; i++)
+    {
+        concurrent_node *node = atomic_load_explicit(&old_buckets->heads[i], memory_order_relaxed);
+        for (; node != NULL; node = atomic_load_explicit(&node->next, memory_order_relaxed))
+        {
+            concurrent_node *copy = create_concurrent_node(node->key, strlen(node->key), node->hash,
+                                                           atomic_load_explicit(&node->val, memory_order_relaxed));
+            if (copy == NULL)
+            {
+                free_concurrent_buckets(new_buckets);
+                new_buckets = NULL;
+                break;
+            }
+            concurrent_node *_Atomic *head = &new_buckets->heads[node->hash & (size - 1)];
+            atomic_store_explicit(&copy->next, atomic_load_explicit(head, memory_order_relaxed), memory_order_relaxed);
+            atomic_store_explicit(head, copy, memory_order_relaxed);
+        }
+    }
+
+    if (new_buckets != NULL)
+        atomic_store_explicit(&table->buckets, new_buckets, memory_order_release);
+    for (int i = CONCURRENT_STRIPES - 1; i >= 0; i--)
+        pthread_mutex_unlock(&table->stripes[i].lock);
+
+    // Wait the readers of the old array before freeing it.
+    if (new_buckets != NULL)
+    {
+        epoch_synchronize(&table->epoch);
+        free_concurrent_buckets(old_buckets);
+    }
+    pthread_mutex_unlock(&table->resize_lock);
+}
+
+/**
+ * Store or add val to the value of a key under its stripe lock, inserting the key if missing.
+ * The value is changed atomically, so lock free readers never see a torn one.
+ * The lock also keeps a resize from copying the node while it changes.
+ */
+static bool update_concurrent_entry(concurrent_hash_table *table, char *key, int val, bool add, int *result)
+{
+    if (table == NULL || key == NULL)
+        return false;
+
+    size_t len = strlen(key);
+    uint64_t hash = table->hash(key, len);
+    concurrent_stripe *stripe = stripe_of(table, hash);
+
+    // The bucket array can't be replaced while a stripe lock is held.
+    pthread_mutex_lock(&stripe->lock);
+    concurrent_buckets *buckets = atomic_load_explicit(&table->buckets, memory_order_relaxed);
+    concurrent_node *_Atomic *head = &buckets->heads[hash & (buckets->size - 1)];
+
+    // Update the element if already exists.
+    for (concurrent_node *node = atomic_load_explicit(head, memory_order_relaxed); node != NULL;
+         node = atomic_load_explicit(&node->next, memory_order_relaxed))
+    {
+        if (node->hash == hash && strcmp(node->key, key) == 0)
+        {
+            int stored = val;
+            if (add)
+                stored += atomic_fetch_add_explicit(&node->val, val, memory_order_relaxed);
+            else
+                atomic_store_explicit(&node->val, val, memory_order_relaxed);
+            pthread_mutex_unlock(&stripe->lock);
+            if (result != NULL)
+                *result = stored;
+            return true;
+        }
+    }
+
+    concurrent_node *new_node = create_concurrent_node(key, len, hash, val);
+    if (new_node == NULL)
+    {
+        pthread_mutex_unlock(&stripe->lock);
+        return false;
+    }
+
+    // Publish the fully built node in front of the chain.
+    atomic_store_explicit(&new_node->next, atomic_load_explicit(head, memory_order_relaxed), memory_order_relaxed);
+    atomic_store_explicit(head, new_node, memory_order_release);
+    stripe->elementCount++;
+
+    bool grow = stripe_over_load(stripe, buckets);
+    pthread_mutex_unlock(&stripe->lock);
+
+    if (grow)
+        resize_buckets(table, 0, stripe);
+    if (result != NULL)
+        *result = val;
+    return true;
+}
+
+/**
+ * Insert a element in the table or update if already exists.
+ * Returns false if the allocation of a new node fails.
+ */
+bool set_concurrent_entry(concurrent_hash_table *table, char *key, int val)
+{
+    return update_concurrent_entry(table, key, val, false, NULL);
+}
+
+/**
+ * Add delta to the value of a key in one scan, a missing key starts at 0.
+ * The new value is copied to result if given.
+ * Returns false if the allocation of a new node fails.
+ */
+bool concurrent_add_entry(concurrent_hash_table *table, char *key, int delta, int *result)
+{
+    return update_concurrent_entry(table, key, delta, true, result);
+}
+
+/**
+ * Queue a unlinked node to be freed after a grace period.
+ * Every CONCURRENT_RETIRE_BATCH nodes the calling thread waits the readers and frees the batch.
+ */
+static void retire_node(concurrent_hash_table *table, concurrent_node *node)
+{
+    concurrent_node *batch = NULL;
+
+    pthread_mutex_lock(&table->retire_lock);
+    node->retired_next = table->retired;
+    table->retired = node;
+    if (++table->retiredCount >= CONCURRENT_RETIRE_BATCH)
+    {
+        batch = table->retired;
+        table->retired = NULL;
+        table->retiredCount = 0;
+    }
+    pthread_mutex_unlock(&table->retire_lock);
+
+    if (batch == NULL)
+        return;
+    epoch_synchronize(&table->epoch);
+    concurrent_node *temp = NULL;
+    while (batch != NULL)
+    {
+        temp = batch;
+        batch = batch->retired_next;
+        free(temp);
+    }
+}
+
+/**
+ * Remove a key from the table.
+ * Readers already on the node keep walking from it until it's reclaimed.
+ */
+bool remove_concurrent_entry(concurrent_hash_table *table, char *key)
+{
+    if (table == NULL || key == NULL)
+        return false;
+
+    uint64_t hash = table->hash(key, strlen(key));
+    concurrent_stripe *stripe = stripe_of(table, hash);
+
+    pthread_mutex_lock(&stripe->lock);
+    concurrent_buckets *buckets = atomic_load_explicit(&table->buckets, memory_order_relaxed);
+    concurrent_node *_Atomic *link = &buckets->heads[hash & (buckets->size - 1)];
+    concurrent_node *node = atomic_load_explicit(link, memory_order_relaxed);
+    while (node != NULL)
+    {
+        if (node->hash == hash && strcmp(node->key, key) == 0)
+        {
+            // Skip the node, its own next pointer stays valid for readers on it.
+            atomic_store_explicit(link, atomic_load_explicit(&node->next, memory_order_relaxed), memory_order_release);
+            stripe->elementCount--;
+            pthread_mutex_unlock(&stripe->lock);
+            retire_node(table, node);
+            return true;
+        }
+        link = &node->next;
+        node = atomic_load_explicit(link, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&stripe->lock);
+    return false;
+}
+
+/**
+ * Grow the table to at least new_size buckets, rounded up to a power of two.
+ * A size at or below the current one leaves the table as it is.
+ */
+void resize_concurrent_hash_table(concurrent_hash_table *table, int new_size)
+{
+    if (table == NULL)
+        return;
+    resize_buckets(table, new_size, NULL);
+}
+
+/**
+ * Count the elements of every stripe.
+ */
+int concurrent_element_count(concurrent_hash_table *table)
+{
+    if (table == NULL)
+        return 0;
+    int count = 0;
+    for (int i = 0; i < CONCURRENT_STRIPES; i++)
+    {
+        pthread_mutex_lock(&table->stripes[i].lock);
+        count += table->stripes[i].elementCount;
+        pthread_mutex_unlock(&table->stripes[i].lock);
+    }
+    return count;
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#ifndef CONCURRENT_HASH_MAP
+#define CONCURRENT_HASH_MAP
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "HashFunctions.h"
+#include "../Sync/Epoch.h"
+
+/// @brief Number of write locks, bucket i is guarded by lock i % CONCURRENT_STRIPES.
+#define CONCURRENT_STRIPES 64
+
+/// @brief Removed nodes kept before a grace period frees them.
+#define CONCURRENT_RETIRE_BATCH 1024
+
+/// @brief Node of a bucket chain, the key is stored right after it.
+/// Nodes are never changed after being published except for the value.
+typedef struct ConcurrentNode
+{
+    struct ConcurrentNode *_Atomic next;
+    struct ConcurrentNode *retired_next;
+    uint64_t hash;
+    _Atomic int val;
+    char key[];
+} concurrent_node;
+
+/// @brief Bucket array, replaced as a whole when the table resizes.
+typedef struct ConcurrentBuckets
+{
+    int size;
+    concurrent_node *_Atomic heads[];
+} concurrent_buckets;
+
+/// @brief Write lock and element count of a set of buckets, one cache line each.
+typedef struct ConcurrentStripe
+{
+    pthread_mutex_t lock;
+    int elementCount;
+} __attribute__((aligned(64))) concurrent_stripe;
+
+/// @brief Hashtable that can be shared by threads.
+/// Searches take no lock, writers lock the stripe of the bucket and a resize locks every stripe.
+/// Unlinked nodes and bucket arrays are freed after the readers that could see them are done.
+typedef struct ConcurrentHashTable
+{
+    concurrent_buckets *_Atomic buckets;
+    concurrent_stripe stripes[CONCURRENT_STRIPES];
+    pthread_mutex_t resize_lock;
+    pthread_mutex_t retire_lock;
+    concurrent_node *retired;
+    int retiredCount;
+    epoch_domain epoch;
+    hash_key_function hash;
+} concurrent_hash_table;
+
+concurrent_hash_table *create_concurrent_hash_table();
+bool search_concurrent_hash_table(concurrent_hash_table *table, char *key, int *val);
+
+void cleanup_concurrent_table(concurrent_hash_table *table);
+bool set_concurrent_entry(concurrent_hash_table *table, char *key, int val);
+bool concurrent_add_entry(concurrent_hash_table *table, char *key, int delta, int *result);
+bool remove_concurrent_entry(concurrent_hash_table *table, char *key);
+void resize_concurrent_hash_table(concurrent_hash_table *table, int new_size);
+int concurrent_element_count(concurrent_hash_table *table);
+
+#endif
\ No newline at end of file
@@ -19,19 +19,39 @@ dll_set_node *create_dll_node(char *key, int val)
         return NULL;
     }
 
-    // Dump the key to preserve the list state.
-    new_node->key = strdup(key);
-    if (new_node->key == NULL)
+    // Copy the key to preserve the list state, short keys stay inside the node.
+    size_t len = strlen(key);
+    if (len < DLL_INLINE_KEY_SIZE)
     {
-        free(new_node);
-        return NULL;
+        memcpy(new_node->inline_key, key, len + 1);
+        new_node->key = new_node->inline_key;
+    }
+    else
+    {
+        new_node->key = strdup(key);
+        if (new_node->key == NULL)
+        {
+            free(new_node);
+            return NULL;
+        }
     }
+    new_node->hash = 0;
     new_node->val = val;
     new_node->next = NULL;
     new_node->prev = NULL;
     return new_node;
 }
 
+/**
+ * Free a node and its key if it was allocated apart.
+ */
+static void free_dll_node(dll_set_node *node)
+{
+    if (node->key != node->inline_key)
+        free(node->key);
+    free(node);
+}
+
 /**
  * Append a double linked nost at the end of the list.
  */
@@ -51,19 +71,66 @@ bool append_dll_set(dll_set_node **head, dll_set_node **tail, char *key, int val
     if (new_node == NULL)
         return false;
 
+    link_dll_node(head, tail, new_node);
+    return true;
+}
+
+/**
+ * Link a existing node at the end of the list.
+ */
+void link_dll_node(dll_set_node **head, dll_set_node **tail, dll_set_node *node)
+{
+    node->next = NULL;
+    node->prev = *tail;
+
     // Initialize the list.
     if (*head == NULL && *tail == NULL)
     {
-        *head = new_node;
-        *tail = new_node;
-        return true;
+        *head = node;
+        *tail = node;
+        return;
     }
 
-    // Append and return true.
-    (*tail)->next = new_node;
-    new_node->prev = *tail;
-    *tail = new_node;
-    return true;
+    (*tail)->next = node;
+    *tail = node;
+}
+
+/**
+ * Unlink a node from the list without freeing it.
+ */
+void unlink_dll_node(dll_set_node **head, dll_set_node **tail, dll_set_node *node)
+{
+    // Handle the case that the element to remove is the head.
+    if (node == *head)
+    {
+        *head = node->next;
+        if (*head != NULL)
+        {
+            (*head)->prev = NULL;
+        }
+    }
+
+    // Handle the case that the element to remove is the tail.
+    if (node == *tail)
+    {
+        *tail = node->prev;
+        if (*tail != NULL)
+        {
+            (*tail)->next = NULL;
+        }
+    }
+
+    // Set the prev and next if possible.
+    if (node->prev != NULL)
+    {
+        node->prev->next = node->next;
+    }
+    if (node->next != NULL)
+    {
+        node->next->prev = node->prev;
+    }
+    node->next = NULL;
+    node->prev = NULL;
 }
 
 /**
@@ -77,8 +144,7 @@ void cleanup_dll_set(dll_set_node *head)
     {
         temp = head;
         head = head->next;
-        free(temp->key);
-        free(temp);
+        free_dll_node(temp);
     }
 }
 
@@ -113,39 +179,10 @@ bool remove_dll_set(dll_set_node **head, dll_set_node **tail, char *key)
         // Verify if the current element is the one to remove.
         if (strcmp(cur->key, key) == 0)
         {
-            // Handle the case that the element to remove is the head.
-            if (cur == *head)
-            {
-                *head = cur->next;
-                if (*head != NULL)
-                {
-                    (*head)->prev = NULL;
-                }
-            }
-
-            // Handle the case that the element to remove is the tail.
-            if (cur == *tail)
-            {
-                *tail = cur->prev;
-                if (*tail != NULL)
-                {
-                    (*tail)->next = NULL;
-                }
-            }
-
-            // Set the prev and next if possible.
-            if (cur->prev != NULL)
-            {
-                cur->prev->next = cur->next;
-            }
-            if (cur->next != NULL)
-            {
-                cur->next->prev = cur->prev;
-            }
+            unlink_dll_node(head, tail, cur);
 
             // Clean the memory.
-            free(cur->key);
-            free(cur);
+            free_dll_node(cur);
             return true;
         }
         cur = cur->next;
@@ -183,4 +220,46 @@ dll_set_node *search_dll_set(dll_set_node *head, dll_set_node *tail, char *key)
     if (strcmp(start->key, key) == 0)
         return start;
     return NULL;
-}
\ No newline at end of file
+}
+
+/**
+ * Search for a element in a list whose nodes cache the hash of their keys.
+ * The key is only compared when the hashes match.
+ * Returns the node, might return NULL if wrong params provided or result not found.
+ */
+dll_set_node *search_dll_set_hashed(dll_set_node *head, char *key, uint64_t hash)
+{
+    if (key == NULL)
+        return NULL;
+
+    for (dll_set_node *cur = head; cur != NULL; cur = cur->next)
+    {
+        if (cur->hash == hash && strcmp(cur->key, key) == 0)
+            return cur;
+    }
+    return NULL;
+}
+
+#ifdef HASH_MAP_STATS
+/**
+ * Same as search_dll_set_hashed, visited and compared receive the count of nodes walked and keys compared.
+ */
+dll_set_node *search_dll_set_hashed_counted(dll_set_node *head, char *key, uint64_t hash, int *visited, int *compared)
+{
+    *visited = 0;
+    *compared = 0;
+    if (key == NULL)
+        return NULL;
+
+    for (dll_set_node *cur = head; cur != NULL; cur = cur->next)
+    {
+        (*visited)++;
+        if (cur->hash != hash)
+            continue;
+        (*compared)++;
+        if (strcmp(cur->key, key) == 0)
+            return cur;
+    }
+    return NULL;
+}
+#endif
\ No newline at end of file
@@ -1,22 +1,39 @@
 #ifndef DLL_SET
 #define DLL_SET
 #include <stdbool.h>
+#include <stdint.h>
+
+/// @brief Space for short keys inside the node, keys up to 23 chars don't need another allocation.
+#define DLL_INLINE_KEY_SIZE 24
 
 /// @brief Double Linked List Node with key-value pair.
+/// The hash is cached by the owner of the list, plain lists leave it as 0.
+/// The key points to inline_key when it fits. The node is 64 bytes, it fills a single line
+/// when the allocator aligns it, as the node pool does for nodes without payload.
+/// Owners may allocate extra bytes after the node, reached through payload.
 typedef struct dllsn
 {
+    uint64_t hash;
     int val;
     char *key;
     struct dllsn *next;
     struct dllsn *prev;
+    char inline_key[DLL_INLINE_KEY_SIZE];
+    unsigned char payload[];
 } dll_set_node;
 
 dll_set_node *create_dll_node(char *key, int val);
 dll_set_node *search_dll_set(dll_set_node *head, dll_set_node *tail, char *key);
+dll_set_node *search_dll_set_hashed(dll_set_node *head, char *key, uint64_t hash);
+#ifdef HASH_MAP_STATS
+dll_set_node *search_dll_set_hashed_counted(dll_set_node *head, char *key, uint64_t hash, int *visited, int *compared);
+#endif
 
 bool append_dll_set(dll_set_node **head, dll_set_node **tail, char *key, int val);
 void cleanup_dll_set(dll_set_node *head);
 bool remove_dll_set(dll_set_node **head, dll_set_node **tail, char *key);
 void traverse_dll_set(dll_set_node *head);
+void link_dll_node(dll_set_node **head, dll_set_node **tail, dll_set_node *node);
+void unlink_dll_node(dll_set_node **head, dll_set_node **tail, dll_set_node *node);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,240 @@
+#include "FlatHashMap.h"
+#include "HashFunctions.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Hash the key with the default word hash.
+ * The low 7 bits are the control tag and the rest selects the first group.
+ */
+static uint64_t flat_hash(const char *key)
+{
+    return hash_bytes_words(key, strlen(key));
+}
+
+/**
+ * Compare a group of control bytes against a tag.
+ * Returns a bitmask with one bit set for each matching byte.
+ */
+static uint32_t match_group(const signed char *group, signed char tag)
+{
+#if defined(__SSE2__)
+    __m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(tag)));
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < FLAT_GROUP_WIDTH; i++)
+        mask |= (uint32_t)(group[i] == tag) << i;
+    return mask;
+#endif
+}
+
+/**
+ * Set a control byte and its clone after the end of the array.
+ * The clones let a group that starts near the end be loaded without wrapping.
+ */
+static void set_ctrl(flat_hash_table *table, int index, signed char tag)
+{
+    table->ctrl[index] = tag;
+    table->ctrl[((index - FLAT_GROUP_WIDTH) & (table->size - 1)) + FLAT_GROUP_WIDTH] = tag;
+}
+
+/**
+ * Find the entry holding the key, NULL if it isn't on the table.
+ */
+static flat_entry *find_entry(flat_hash_table *table, const char *key, uint64_t hash)
+{
+    int mask = table->size - 1;
+    signed char tag = (signed char)(hash & 0x7F);
+    int pos = (int)((hash >> 7) & mask);
+
+    // Probe group by group with a triangular sequence, every group is visited once.
+    for (int stride = FLAT_GROUP_WIDTH;; stride += FLAT_GROUP_WIDTH)
+    {
+        const signed char *group = table->ctrl + pos;
+        uint32_t matches = match_group(group, tag);
+        while (matches != 0)
+        {
+            int index = (pos + __builtin_ctz(matches)) & mask;
+            if (strcmp(table->entries[index].key, key) == 0)
+                return &table->entries[index];
+            matches &= matches - 1;
+        }
+
+        // An empty slot ends the probe sequence.
+        if (match_group(group, FLAT_CTRL_EMPTY) != 0)
+            return NULL;
+        pos = (pos + stride) & mask;
+    }
+}
+
+/**
+ * Find the first empty slot on the probe sequence of a hash.
+ */
+static int find_empty_slot(flat_hash_table *table, uint64_t hash)
+{
+    int mask = table->size - 1;
+    int pos = (int)((hash >> 7) & mask);
+    for (int stride = FLAT_GROUP_WIDTH;; stride += FLAT_GROUP_WIDTH)
+    {
+        uint32_t empty = match_group(table->ctrl + pos, FLAT_CTRL_EMPTY);
+        if (empty != 0)
+            return (pos + __builtin_ctz(empty)) & mask;
+        pos = (pos + stride) & mask;
+    }
+}
+
+/**
+ * Allocate the control bytes and entries for a given size.
+ */
+static bool allocate_slots(flat_hash_table *table, int size)
+{
+    signed char *ctrl = malloc(size + FLAT_GROUP_WIDTH);
+    if (ctrl == NULL)
+        return false;
+    flat_entry *entries = malloc(size * sizeof(flat_entry));
+    if (entries == NULL)
+    {
+        free(ctrl);
+        return false;
+    }
+    memset(ctrl, FLAT_CTRL_EMPTY, size + FLAT_GROUP_WIDTH);
+    table->ctrl = ctrl;
+    table->entries = entries;
+    table->size = size;
+    return true;
+}
+
+/**
+ * Create and return a flat hash table.
+ */
+flat_hash_table *create_flat_hash_table()
+{
+    flat_hash_table *new_table = malloc(sizeof(flat_hash_table));
+    if (new_table == NULL)
+        return NULL;
+
+    // The size must be a power of two and hold at least one full group.
+    if (!allocate_slots(new_table, FLAT_GROUP_WIDTH))
+    {
+        free(new_table);
+        return NULL;
+    }
+    new_table->elementCount = 0;
+    return new_table;
+}
+
+/**
+ * Cleanup the table.
+ */
+void cleanup_flat_table(flat_hash_table *table)
+{
+    if (table == NULL)
+        return;
+    for (int i = 0; i < table->size; i++)
+    {
+        if (table->ctrl[i] != FLAT_CTRL_EMPTY)
+            free(table->entries[i].key);
+    }
+    free(table->ctrl);
+    free(table->entries);
+    free(table);
+}
+
+/**
+ * Resize the table, the size is rounded up to a power of two.
+ * Keys are moved to the new slots without being copied.
+ * Returns false if the new size can't hold the current elements.
+ */
+bool resize_flat_hash_table(flat_hash_table *table, int new_size)
+{
+    if (table == NULL)
+        return false;
+
+    int size = FLAT_GROUP_WIDTH;
+    while (size < new_size)
+        size *= 2;
+    if (table->elementCount > size / 8 * 7)
+        return false;
+
+    flat_hash_table old = *table;
+    if (!allocate_slots(table, size))
+        return false;
+
+    // Re-insert each full slot of the old arrays.
+    for (int i = 0; i < old.size; i++)
+    {
+        if (old.ctrl[i] == FLAT_CTRL_EMPTY)
+            continue;
+        uint64_t hash = flat_hash(old.entries[i].key);
+        int index = find_empty_slot(table, hash);
+        set_ctrl(table, index, (signed char)(hash & 0x7F));
+        table->entries[index] = old.entries[i];
+    }
+    free(old.ctrl);
+    free(old.entries);
+    return true;
+}
+
+/**
+ * Insert a element in the flat table or update if already exists.
+ */
+void set_flat_entry(flat_hash_table *table, char *key, int val)
+{
+    if (table == NULL || key == NULL)
+        return;
+
+    uint64_t hash = flat_hash(key);
+    flat_entry *entry = find_entry(table, key, hash);
+    if (entry != NULL)
+    {
+        entry->val = val;
+        return;
+    }
+
+    // Grow before inserting when the table would go over 7/8 of the slots.
+    if (table->elementCount + 1 > table->size / 8 * 7)
+    {
+        if (!resize_flat_hash_table(table, table->size * 2))
+            return;
+    }
+
+    char *dup = strdup(key);
+    if (dup == NULL)
+        return;
+    int index = find_empty_slot(table, hash);
+    set_ctrl(table, index, (signed char)(hash & 0x7F));
+    table->entries[index].key = dup;
+    table->entries[index].val = val;
+    table->elementCount++;
+}
+
+/**
+ * Search for a key and return the respective entry.
+ * Might return NULL if not found.
+ */
+flat_entry *search_flat_hash_table(flat_hash_table *table, char *key)
+{
+    if (table == NULL || key == NULL)
+        return NULL;
+    return find_entry(table, key, flat_hash(key));
+}
+
+/**
+ * Traverse each element on the flat table.
+ */
+void traverse_flat_hash_table(flat_hash_table *table)
+{
+    if (table == NULL)
+        return;
+    for (int i = 0; i < table->size; i++)
+    {
+        if (table->ctrl[i] != FLAT_CTRL_EMPTY)
+            printf("Slot[%d]: (%s,%d)\n", i, table->entries[i].key, table->entries[i].val);
+    }
+}
\ No newline at end of file
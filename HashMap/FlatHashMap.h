@@ -0,0 +1,37 @@
+#ifndef FLAT_HASH_MAP
+#define FLAT_HASH_MAP
+#include <stdbool.h>
+
+/// @brief Number of control bytes matched at once during a probe.
+#define FLAT_GROUP_WIDTH 16
+
+/// @brief Control byte for a slot that never held an entry.
+#define FLAT_CTRL_EMPTY ((signed char)-128)
+
+/// @brief Single slot of the flat table, the key is owned by the table.
+typedef struct FlatEntry
+{
+    char *key;
+    int val;
+} flat_entry;
+
+/// @brief Open addressing hashtable with one control byte per slot.
+/// Full slots store the low 7 bits of the hash in the control byte, so a probe
+/// compares a whole group of tags before touching any key.
+typedef struct FlatHashTable
+{
+    signed char *ctrl;
+    flat_entry *entries;
+    int size;
+    int elementCount;
+} flat_hash_table;
+
+flat_hash_table *create_flat_hash_table();
+flat_entry *search_flat_hash_table(flat_hash_table *table, char *key);
+
+void cleanup_flat_table(flat_hash_table *table);
+void set_flat_entry(flat_hash_table *table, char *key, int val);
+bool resize_flat_hash_table(flat_hash_table *table, int new_size);
+void traverse_flat_hash_table(flat_hash_table *table);
+
+#endif
\ No newline at end of file
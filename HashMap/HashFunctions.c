@@ -0,0 +1,87 @@
+#include "HashFunctions.h"
+#include <string.h>
+
+#define WORD_HASH_SEED 0xa0761d6478bd642fULL
+#define WORD_HASH_MULT 0xe7037ed1a0b428dbULL
+#define WORD_HASH_LAST 0x8ebc6af09c88c6e3ULL
+
+/**
+ * Read 8 bytes of a unaligned key.
+ */
+static uint64_t read_u64(const char *p)
+{
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+    return word;
+}
+
+/**
+ * Read 4 bytes of a unaligned key.
+ */
+static uint64_t read_u32(const char *p)
+{
+    uint32_t word;
+    memcpy(&word, p, sizeof(word));
+    return word;
+}
+
+/**
+ * Multiply to 128 bits and fold the halves, mixing every bit of both inputs.
+ */
+static uint64_t fold_multiply(uint64_t a, uint64_t b)
+{
+    __uint128_t product = (__uint128_t)a * b;
+    return (uint64_t)product ^ (uint64_t)(product >> 64);
+}
+
+/**
+ * Hash the key one byte at a time with FNV-1a.
+ */
+uint64_t hash_bytes_fnv1a(const char *key, size_t len)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < len; i++)
+    {
+        hash ^= (unsigned char)key[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * Hash the key 16 bytes at a time.
+ * The tail is read with overlapping loads, so there is no byte loop at all.
+ */
+uint64_t hash_bytes_words(const char *key, size_t len)
+{
+    uint64_t hash = WORD_HASH_SEED ^ fold_multiply(len ^ WORD_HASH_SEED, WORD_HASH_MULT);
+    const char *p = key;
+    size_t left = len;
+
+    // Mix two words per step into the state.
+    while (left > 16)
+    {
+        hash = fold_multiply(read_u64(p) ^ WORD_HASH_MULT, read_u64(p + 8) ^ hash);
+        p += 16;
+        left -= 16;
+    }
+
+    // Load the last 1 to 16 bytes, the reads may overlap the ones already mixed.
+    uint64_t a = 0;
+    uint64_t b = 0;
+    if (left > 8)
+    {
+        a = read_u64(p);
+        b = read_u64(p + left - 8);
+    }
+    else if (left >= 4)
+    {
+        a = read_u32(p);
+        b = read_u32(p + left - 4);
+    }
+    else if (left > 0)
+    {
+        a = ((uint64_t)(unsigned char)p[0] << 16) | ((uint64_t)(unsigned char)p[left / 2] << 8) | (unsigned char)p[left - 1];
+    }
+    return fold_multiply(WORD_HASH_LAST ^ len, fold_multiply(a ^ WORD_HASH_MULT, b ^ hash));
+}
\ No newline at end of file
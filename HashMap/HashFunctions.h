@@ -0,0 +1,26 @@
+#ifndef HASH_FUNCTIONS
+#define HASH_FUNCTIONS
+#include <stddef.h>
+#include <stdint.h>
+
+/// @brief Hash of a key with a known length, used to make the table hash pluggable.
+typedef uint64_t (*hash_key_function)(const char *key, size_t len);
+
+uint64_t hash_bytes_fnv1a(const char *key, size_t len);
+uint64_t hash_bytes_words(const char *key, size_t len);
+
+/**
+ * Hash a integer key with the murmur3 finalizer, every input bit flips half of the output bits.
+ * Inline so the integer maps can hash without a call.
+ */
+static inline uint64_t hash_u64(uint64_t key)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+#endif
\ No newline at end of file
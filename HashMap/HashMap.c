@@ -1,57 +1,207 @@
 #include "HashMap.h"
+#include <pthread.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+
+#define HASH_PREFETCH(addr) __builtin_prefetch(addr)
+
+#ifdef HASH_MAP_STATS
+#include <time.h>
+
+/**
+ * Get a monotonic timestamp in nanoseconds for the resize counters.
+ */
+static unsigned long long stat_now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#define HASH_STAT_TIMER(name) unsigned long long name = stat_now_ns()
+#define HASH_STAT_ELAPSED(table, name) HASH_STAT_ADD(table, resize_ns, stat_now_ns() - (name))
+#else
+#define HASH_STAT_TIMER(name) ((void)0)
+#define HASH_STAT_ELAPSED(table, name) ((void)0)
+#endif
 
 /**
- * Create and return a hash table.
+ * Allocate an array of empty buckets.
+ * The buckets live right after the pointers, so a single free releases both.
+ * Returns NULL if the allocation fails.
+ */
+static bucket **allocate_buckets(int size)
+{
+    bucket **buckets = malloc(size * (sizeof(bucket *) + sizeof(bucket)));
+    if (buckets == NULL)
+        return NULL;
+
+    // Point to each bucket and initialize the head and tail.
+    bucket *storage = (bucket *)(buckets + size);
+    for (int i = 0; i < size; i++)
+    {
+        buckets[i] = &storage[i];
+        buckets[i]->head = NULL;
+        buckets[i]->tail = NULL;
+        buckets[i]->count = 0;
+        buckets[i]->tree = NULL;
+    }
+    return buckets;
+}
+
+/**
+ * Drop the tree of a bucket, lookups go back to walking the chain.
+ */
+static void untreeify_bucket(bucket *cur_bucket)
+{
+    cleanup_chain_tree(cur_bucket->tree);
+    cur_bucket->tree = NULL;
+}
+
+/**
+ * Index every node of a long chain by a tree.
+ * The tree only speeds lookups up, so if it can't be built the bucket stays a plain chain.
+ */
+static void treeify_bucket(bucket *cur_bucket)
+{
+    for (dll_set_node *cur = cur_bucket->head; cur != NULL; cur = cur->next)
+    {
+        if (!chain_tree_insert(&cur_bucket->tree, cur))
+        {
+            untreeify_bucket(cur_bucket);
+            return;
+        }
+    }
+}
+
+/**
+ * Append a node to a bucket, keeping its tree and count in sync.
+ * Every node enters a bucket through here.
+ */
+static void link_bucket_node(bucket *cur_bucket, dll_set_node *node)
+{
+    link_dll_node(&cur_bucket->head, &cur_bucket->tail, node);
+    cur_bucket->count++;
+    if (cur_bucket->tree != NULL)
+    {
+        if (!chain_tree_insert(&cur_bucket->tree, node))
+            untreeify_bucket(cur_bucket);
+    }
+    else if (cur_bucket->count > HASH_TABLE_TREEIFY)
+        treeify_bucket(cur_bucket);
+}
+
+/**
+ * Unlink a node from a bucket, keeping its tree and count in sync.
+ * Every node leaves a bucket through here.
+ */
+static void unlink_bucket_node(bucket *cur_bucket, dll_set_node *node)
+{
+    if (cur_bucket->tree != NULL)
+        chain_tree_remove(&cur_bucket->tree, node);
+    unlink_dll_node(&cur_bucket->head, &cur_bucket->tail, node);
+    cur_bucket->count--;
+    if (cur_bucket->tree != NULL && cur_bucket->count < HASH_TABLE_UNTREEIFY)
+        untreeify_bucket(cur_bucket);
+}
+
+/**
+ * Free the trees of every bucket of a array.
+ */
+static void free_bucket_trees(bucket **buckets, int size)
+{
+    for (int i = 0; buckets != NULL && i < size; i++)
+        untreeify_bucket(buckets[i]);
+}
+
+/**
+ * Round a size up to the next power of two.
+ */
+static int round_up_power_of_two(int size)
+{
+    int rounded = 1;
+    while (rounded < size)
+        rounded *= 2;
+    return rounded;
+}
+
+/**
+ * Create and return a hash table using the default word hash.
  */
 hash_table *create_hash_table()
 {
+    return create_hash_table_with_hash(hash_bytes_words);
+}
+
+/**
+ * Create and return a hash table using the given hash function.
+ */
+hash_table *create_hash_table_with_hash(hash_key_function hash)
+{
+    return create_hash_table_with_options(hash, 0);
+}
+
+/**
+ * Create and return a hash table whose entries carry value_size bytes of payload.
+ */
+hash_table *create_hash_table_with_payload(size_t value_size)
+{
+    return create_hash_table_with_options(hash_bytes_words, value_size);
+}
+
+/**
+ * Create and return a hash table with the given hash function and payload size.
+ */
+hash_table *create_hash_table_with_options(hash_key_function hash, size_t value_size)
+{
+    if (hash == NULL)
+        return NULL;
+
     // Allocate the new table.
     hash_table *new_table = malloc(sizeof(hash_table));
     if (new_table == NULL)
         return NULL;
 
-    // Set the default size as 11 and allocate the array of buckets.
-    new_table->size = 11;
-    new_table->buckets = malloc(new_table->size * sizeof(bucket *));
+    // Set the default size and allocate the array of buckets.
+    new_table->size = HASH_TABLE_INITIAL_SIZE;
+    new_table->buckets = allocate_buckets(new_table->size);
     if (new_table->buckets == NULL)
     {
         free(new_table);
         return NULL;
     }
 
-    // Allocate each bucket and initialize the head and tail.
-    for (int i = 0; i < new_table->size; i++)
-    {
-        new_table->buckets[i] = malloc(sizeof(bucket));
-        if (new_table->buckets[i] == NULL)
-        {
-            // Free the previous buckets in case of failure.
-            for (int j = 0; j < i; j++)
-                free(new_table->buckets[j]);
-
-            free(new_table->buckets);
-            free(new_table);
-            return NULL;
-        }
-        new_table->buckets[i]->head = NULL;
-        new_table->buckets[i]->tail = NULL;
-    }
-
     new_table->elementCount = 0;
+    new_table->old_buckets = NULL;
+    new_table->old_size = 0;
+    new_table->migrate_index = 0;
+    new_table->incremental = false;
+    init_node_pool(&new_table->pool, value_size);
+    new_table->hash = hash;
+    new_table->value_size = value_size;
+    memset(&new_table->counters, 0, sizeof(hash_table_counters));
+    new_table->bloom = NULL;
+    new_table->bloom_stale = 0;
+    new_table->bloom_next = NULL;
+    new_table->bloom_next_stale = 0;
+    atomic_init(&new_table->open_cursors, 0);
     return new_table;
 }
 
 /**
- * Get the index of the hashmap.
+ * Get the index of a key on a table of the given size using the default hash.
  */
 int hash_function(char *key, int size)
 {
-    unsigned long int hash = 0;
-    while (*key != '\0')
-        hash = (hash * 31 + *key++);
-    return hash % size;
+    return hash_bytes_words(key, strlen(key)) % size;
+}
+
+/**
+ * Get the full hash of a key with the hash function of the table.
+ */
+uint64_t hash_key(hash_table *table, char *key)
+{
+    return table->hash(key, strlen(key));
 }
 
 /**
@@ -61,102 +211,771 @@ void cleanup_table(hash_table *table)
 {
     if (table == NULL)
         return;
-    // Clean up each bucket/linked list.
+    // Every node and key lives on the pool, release them in bulk.
+    cleanup_node_pool(&table->pool);
+    free_bucket_trees(table->buckets, table->size);
+    free_bucket_trees(table->old_buckets, table->old_size);
+
+    disable_bloom_filter(table);
+
+    // Free the buckets, the ones a incremental resize didn't move yet and the table itself.
+    free(table->buckets);
+    free(table->old_buckets);
+    free(table);
+}
+
+/**
+ * Get the capacity of a Bloom filter sized for the current table.
+ */
+static size_t bloom_capacity(hash_table *table)
+{
+    size_t capacity = table->size - table->size / 4;
+    if (capacity < (size_t)table->elementCount)
+        capacity = table->elementCount;
+    return capacity;
+}
+
+/**
+ * Drop the filter a incremental resize is building.
+ */
+static void drop_next_bloom_filter(hash_table *table)
+{
+    if (table->bloom_next == NULL)
+        return;
+    cleanup_bloom_filter(table->bloom_next);
+    free(table->bloom_next);
+    table->bloom_next = NULL;
+    table->bloom_next_stale = 0;
+}
+
+/**
+ * Start the filter of the new array when a incremental resize begins.
+ * bloom keeps answering for every key until the migration ends, so if the
+ * new filter can't be allocated the table only keeps the old one.
+ */
+static void start_next_bloom_filter(hash_table *table)
+{
+    drop_next_bloom_filter(table);
+    if (table->bloom == NULL)
+        return;
+    table->bloom_next = malloc(sizeof(bloom_filter));
+    if (table->bloom_next == NULL)
+        return;
+    if (!init_bloom_filter(table->bloom_next, bloom_capacity(table), table->bloom->fp_rate))
+    {
+        free(table->bloom_next);
+        table->bloom_next = NULL;
+    }
+}
+
+/**
+ * Replace the filter with the one built during the migration.
+ */
+static void swap_in_next_bloom_filter(hash_table *table)
+{
+    if (table->bloom_next == NULL)
+        return;
+    table->bloom_next->misses_avoided = table->bloom->misses_avoided;
+    cleanup_bloom_filter(table->bloom);
+    free(table->bloom);
+    table->bloom = table->bloom_next;
+    table->bloom_stale = table->bloom_next_stale;
+    table->bloom_next = NULL;
+    table->bloom_next_stale = 0;
+}
+
+/**
+ * Refill the Bloom filter from the cached hashes, sized for the current table.
+ * Drops the stale bits of removed keys. If the new filter can't be allocated
+ * the table keeps working without one. Walks every entry, so it only runs on
+ * a stop the world resize or when the stale bits outnumber the keys.
+ */
+static void rebuild_bloom_filter(hash_table *table)
+{
+    if (table->bloom == NULL)
+        return;
+
+    // The refilled filter covers the old buckets too, a filter built along isn't needed.
+    drop_next_bloom_filter(table);
+    double fp_rate = table->bloom->fp_rate;
+    unsigned long long avoided = table->bloom->misses_avoided;
+    cleanup_bloom_filter(table->bloom);
+    if (!init_bloom_filter(table->bloom, bloom_capacity(table), fp_rate))
+    {
+        free(table->bloom);
+        table->bloom = NULL;
+        return;
+    }
+    table->bloom->misses_avoided = avoided;
+    table->bloom_stale = 0;
+
     for (int i = 0; i < table->size; i++)
+        for (dll_set_node *cur = table->buckets[i]->head; cur != NULL; cur = cur->next)
+            bloom_add(table->bloom, cur->hash);
+    for (int i = table->migrate_index; table->old_buckets != NULL && i < table->old_size; i++)
+        for (dll_set_node *cur = table->old_buckets[i]->head; cur != NULL; cur = cur->next)
+            bloom_add(table->bloom, cur->hash);
+}
+
+/**
+ * Move every node of a old bucket to the current buckets.
+ * The nodes are relinked, nothing is copied or freed.
+ */
+static void migrate_bucket(hash_table *table, bucket *old_bucket)
+{
+    untreeify_bucket(old_bucket);
+    dll_set_node *cur = old_bucket->head;
+    dll_set_node *next = NULL;
+    while (cur != NULL)
     {
-        if (table->buckets[i])
-        {
-            cleanup_dll_set(table->buckets[i]->head);
-            free(table->buckets[i]);
-        }
+        // Mask the cached hash to the new size and link to the new bucket.
+        next = cur->next;
+        link_bucket_node(table->buckets[cur->hash & (table->size - 1)], cur);
+        if (table->bloom_next != NULL)
+            bloom_add(table->bloom_next, cur->hash);
+        cur = next;
     }
-    // Free the pointer to the buckets and the table itself.
-    free(table->buckets);
-    free(table);
+    old_bucket->head = NULL;
+    old_bucket->tail = NULL;
+    old_bucket->count = 0;
 }
 
 /**
- * Insert a element in the hash table or update if already exists.
+ * Move up to HASH_TABLE_MIGRATE_STEP old buckets when a incremental resize is running.
  */
-void set_entry(hash_table *table, char *key, int val)
+static void migrate_step(hash_table *table)
 {
-    if (table == NULL || key == NULL)
+    if (table->old_buckets == NULL)
         return;
+    HASH_STAT_TIMER(start);
+
+    for (int i = 0; i < HASH_TABLE_MIGRATE_STEP && table->migrate_index < table->old_size; i++)
+        migrate_bucket(table, table->old_buckets[table->migrate_index++]);
+
+    // Every old bucket was moved, drop the old array and switch to the filter built along.
+    if (table->migrate_index == table->old_size)
+    {
+        free(table->old_buckets);
+        table->old_buckets = NULL;
+        table->old_size = 0;
+        table->migrate_index = 0;
+        swap_in_next_bloom_filter(table);
+    }
+    HASH_STAT_ELAPSED(table, start);
+}
+
+/**
+ * Move some old buckets on a lookup, unless a cursor is walking the buckets.
+ * Writers always migrate, they invalidate the cursors anyway.
+ */
+static void migrate_on_lookup(hash_table *table)
+{
+    if (atomic_load_explicit(&table->open_cursors, memory_order_relaxed) == 0)
+        migrate_step(table);
+}
+
+/**
+ * Get the old bucket of a key while a incremental resize is running.
+ * Returns NULL if there is no resize or the bucket was already moved.
+ */
+static bucket *old_bucket_of(hash_table *table, uint64_t hash)
+{
+    if (table->old_buckets == NULL)
+        return NULL;
+    int index = hash & (table->old_size - 1);
+    if (index < table->migrate_index)
+        return NULL;
+    return table->old_buckets[index];
+}
+
+/**
+ * Take a node from a pool and store the key inside it, or on the arena if it's too long.
+ * The payload starts zeroed.
+ */
+static dll_set_node *create_pool_entry(node_pool *pool, char *key, uint64_t hash, int val)
+{
+    dll_set_node *new_node = alloc_pool_node(pool);
+    if (new_node == NULL)
+        return NULL;
 
-    // Hash the key.
-    int index = hash_function(key, table->size);
-    bucket *cur_bucket = table->buckets[index];
-    // Append to the respective bucket and increase the element counter if sucessfull.
-    if (append_dll_set(&cur_bucket->head, &cur_bucket->tail, key, val))
-        table->elementCount++;
+    size_t len = strlen(key);
+    if (len < DLL_INLINE_KEY_SIZE)
+    {
+        memcpy(new_node->inline_key, key, len + 1);
+        new_node->key = new_node->inline_key;
+    }
     else
     {
-        // Update the element if already exists.
-        dll_set_node *toUpdate = search_dll_set(cur_bucket->head, cur_bucket->tail, key);
-        if (toUpdate == NULL)
+        new_node->key = pool_strdup(pool, key);
+        if (new_node->key == NULL)
         {
-            return;
+            free_pool_node(pool, new_node);
+            return NULL;
         }
-        toUpdate->val = val;
     }
+    new_node->hash = hash;
+    new_node->val = val;
+    memset(new_node->payload, 0, pool->node_size - sizeof(dll_set_node));
+    return new_node;
+}
+
+/**
+ * Search a bucket for a key, through its tree if it has one.
+ */
+static dll_set_node *find_in_bucket(hash_table *table, bucket *cur_bucket, char *key, uint64_t hash)
+{
+#ifdef HASH_MAP_STATS
+    int visited = 0;
+    int compared = 0;
+    dll_set_node *found;
+    if (cur_bucket->tree == NULL)
+        found = search_dll_set_hashed_counted(cur_bucket->head, key, hash, &visited, &compared);
+    else
+        found = chain_tree_find_counted(cur_bucket->tree, key, hash, &visited);
+    HASH_STAT_ADD(table, probes, visited);
+    HASH_STAT_ADD(table, key_compares, compared);
+    return found;
+#else
+    (void)table;
+    if (cur_bucket->tree == NULL)
+        return search_dll_set_hashed(cur_bucket->head, key, hash);
+    return chain_tree_find(cur_bucket->tree, key, hash);
+#endif
+}
+
+/**
+ * Find a key with a already computed hash on the current and old buckets.
+ */
+static dll_set_node *find_hashed(hash_table *table, char *key, uint64_t hash)
+{
+    HASH_STAT_ADD(table, lookups, 1);
+
+    // A key the filter never saw isn't on the table.
+    if (table->bloom != NULL && !bloom_may_contain(table->bloom, hash))
+    {
+        table->bloom->misses_avoided++;
+        return NULL;
+    }
+
+    bucket *cur_bucket = table->buckets[hash & (table->size - 1)];
+    dll_set_node *found = find_in_bucket(table, cur_bucket, key, hash);
+    if (found != NULL)
+        return found;
+
+    // The key might not be moved yet.
+    bucket *old_bucket = old_bucket_of(table, hash);
+    if (old_bucket == NULL)
+        return NULL;
+    return find_in_bucket(table, old_bucket, key, hash);
+}
+
+/**
+ * Find a key with a already computed hash, inserting it with val if missing.
+ * The chains are scanned once, a existing value is left as it is.
+ * Returns the node of the key, NULL if it couldn't be inserted.
+ */
+static dll_set_node *upsert_hashed(hash_table *table, char *key, uint64_t hash, int val, bool *inserted)
+{
+    HASH_STAT_ADD(table, lookups, 1);
+    *inserted = false;
+
+    // The element might still live in a old bucket.
+    bucket *old_bucket = old_bucket_of(table, hash);
+    if (old_bucket != NULL)
+    {
+        dll_set_node *found = find_in_bucket(table, old_bucket, key, hash);
+        if (found != NULL)
+            return found;
+    }
+
+    bucket *cur_bucket = table->buckets[hash & (table->size - 1)];
+    dll_set_node *found = find_in_bucket(table, cur_bucket, key, hash);
+    if (found != NULL)
+        return found;
+
+    // Take the node and the key from the pool and append to the respective bucket.
+    dll_set_node *new_node = create_pool_entry(&table->pool, key, hash, val);
+    if (new_node == NULL)
+        return NULL;
+    link_bucket_node(cur_bucket, new_node);
+    table->elementCount++;
+    if (table->bloom != NULL)
+        bloom_add(table->bloom, hash);
+    if (table->bloom_next != NULL)
+        bloom_add(table->bloom_next, hash);
+    *inserted = true;
 
     // Resize the table when the count of elements is 75% of the size.
+    // Nodes are relinked, not copied, so the node stays valid.
     if (0.75 < (float)(table->elementCount) / table->size)
         resize_hash_table(table, table->size * 2);
+    return new_node;
 }
 
 /**
- * Resize the hash table.
+ * Insert or update a key with a already computed hash.
+ * Returns the node of the key, NULL if it couldn't be inserted.
  */
-void resize_hash_table(hash_table *table, int new_size)
+static dll_set_node *set_hashed_entry(hash_table *table, char *key, uint64_t hash, int val)
 {
-    if (table == NULL)
+    bool inserted = false;
+    dll_set_node *node = upsert_hashed(table, key, hash, val, &inserted);
+    if (node != NULL && !inserted)
+        node->val = val;
+    return node;
+}
+
+/**
+ * Insert a element in the hash table or update if already exists.
+ */
+void set_entry(hash_table *table, char *key, int val)
+{
+    if (table == NULL || key == NULL)
         return;
 
-    // Allocate the new buckets.
-    bucket **new_buckets = malloc(new_size * sizeof(bucket *));
-    if (new_buckets == NULL)
+    migrate_step(table);
+    set_hashed_entry(table, key, hash_key(table, key), val);
+}
+
+/**
+ * Insert or update a key and copy value_size bytes of value to its payload.
+ * A new key gets 0 as its int value.
+ * Returns the payload of the entry, NULL if it couldn't be inserted.
+ */
+void *set_entry_payload(hash_table *table, char *key, const void *value)
+{
+    if (table == NULL || key == NULL || value == NULL)
+        return NULL;
+
+    migrate_step(table);
+    bool inserted = false;
+    dll_set_node *node = upsert_hashed(table, key, hash_key(table, key), 0, &inserted);
+    if (node == NULL)
+        return NULL;
+    memcpy(node->payload, value, table->value_size);
+    return node->payload;
+}
+
+/**
+ * Get the node of a key, inserting it with default_val if missing.
+ * The key is hashed and its chain scanned once. inserted, if given, tells if the key is new.
+ * The node stays valid until the key is removed or the table is compacted.
+ * Returns NULL if the key couldn't be inserted.
+ */
+dll_set_node *get_or_insert_node(hash_table *table, char *key, int default_val, bool *inserted)
+{
+    if (table == NULL || key == NULL)
     {
-        return;
+        if (inserted != NULL)
+            *inserted = false;
+        return NULL;
     }
+    return get_or_insert_hashed(table, key, hash_key(table, key), default_val, inserted);
+}
 
-    // Allocate memory and initialize each bucket.
-    for (int i = 0; i < new_size; i++)
-    {
-        new_buckets[i] = malloc(sizeof(bucket));
-        if (new_buckets[i] == NULL)
-        {
-            // Clean up in case of failure.
-            for (int j = 0; j < i; j++)
-                free(new_buckets[j]);
+/**
+ * Same as get_or_insert_node for a key already hashed by hash_key of this table,
+ * so callers that route keys by hash don't hash them twice.
+ */
+dll_set_node *get_or_insert_hashed(hash_table *table, char *key, uint64_t hash, int default_val, bool *inserted)
+{
+    bool is_new = false;
+    if (inserted != NULL)
+        *inserted = false;
+    if (table == NULL || key == NULL)
+        return NULL;
 
-            free(new_buckets);
-            return;
-        }
-        new_buckets[i]->head = NULL;
-        new_buckets[i]->tail = NULL;
+    migrate_step(table);
+    dll_set_node *node = upsert_hashed(table, key, hash, default_val, &is_new);
+    if (inserted != NULL)
+        *inserted = is_new;
+    return node;
+}
+
+/**
+ * Get the value slot of a key, inserting it with default_val if missing.
+ * Returns NULL if the key couldn't be inserted.
+ */
+int *get_or_insert(hash_table *table, char *key, int default_val, bool *inserted)
+{
+    dll_set_node *node = get_or_insert_node(table, key, default_val, inserted);
+    return node != NULL ? &node->val : NULL;
+}
+
+/**
+ * Add delta to the value of a key in place, a missing key starts at 0.
+ * Returns the slot of the value, NULL if the key couldn't be inserted.
+ */
+int *add_to_entry(hash_table *table, char *key, int delta)
+{
+    bool inserted = false;
+    int *slot = get_or_insert(table, key, delta, &inserted);
+    if (slot != NULL && !inserted)
+        *slot += delta;
+    return slot;
+}
+
+/**
+ * Search for a key and return its payload.
+ * Might return NULL if not found.
+ */
+void *search_hash_table_payload(hash_table *table, char *key)
+{
+    dll_set_node *node = search_hash_table(table, key);
+    return node != NULL ? node->payload : NULL;
+}
+
+/**
+ * Remove a key from the hash table.
+ * The node goes back to the pool and the table shrinks once the load drops
+ * under HASH_TABLE_SHRINK_LOAD, far enough from the grow threshold to not oscillate.
+ * Returns false if the key isn't on the table.
+ */
+bool remove_entry(hash_table *table, char *key)
+{
+    if (table == NULL || key == NULL)
+        return false;
+
+    migrate_step(table);
+
+    // The key is either on its current bucket or on a old one not moved yet.
+    HASH_STAT_ADD(table, lookups, 1);
+    uint64_t hash = hash_key(table, key);
+    bucket *cur_bucket = table->buckets[hash & (table->size - 1)];
+    dll_set_node *toRemove = find_in_bucket(table, cur_bucket, key, hash);
+    if (toRemove == NULL)
+    {
+        cur_bucket = old_bucket_of(table, hash);
+        if (cur_bucket == NULL)
+            return false;
+        toRemove = find_in_bucket(table, cur_bucket, key, hash);
+        if (toRemove == NULL)
+            return false;
     }
+    else if (table->bloom_next != NULL)
+        table->bloom_next_stale++;
 
-    // Loop through each old bucket.
+    unlink_bucket_node(cur_bucket, toRemove);
+    free_pool_node(&table->pool, toRemove);
+    table->elementCount--;
+
+    // Halve the table, leaving it at the same load a grow leaves it.
+    if (table->old_buckets == NULL && table->size > HASH_TABLE_INITIAL_SIZE &&
+        (float)(table->elementCount) / table->size < HASH_TABLE_SHRINK_LOAD)
+        resize_hash_table(table, table->size / 2);
+    else if (table->bloom != NULL && ++table->bloom_stale > table->elementCount)
+        rebuild_bloom_filter(table);
+    return true;
+}
+
+/**
+ * Remove every entry at once, keeping the bucket array for the next round of inserts.
+ * The pool is released in bulk, so every node pointer returned before is invalidated.
+ */
+void clear_hash_table(hash_table *table)
+{
+    if (table == NULL)
+        return;
+
+    free_bucket_trees(table->buckets, table->size);
+    free_bucket_trees(table->old_buckets, table->old_size);
+    free(table->old_buckets);
+    table->old_buckets = NULL;
+    table->old_size = 0;
+    table->migrate_index = 0;
     for (int i = 0; i < table->size; i++)
     {
-        bucket *old_bucket = table->buckets[i];
-        dll_set_node *cur = old_bucket->head;
-        while (cur != NULL)
+        table->buckets[i]->head = NULL;
+        table->buckets[i]->tail = NULL;
+        table->buckets[i]->count = 0;
+    }
+    cleanup_node_pool(&table->pool);
+    table->elementCount = 0;
+    drop_next_bloom_filter(table);
+    if (table->bloom != NULL)
+    {
+        clear_bloom_filter(table->bloom);
+        table->bloom_stale = 0;
+    }
+}
+
+/**
+ * Get the smallest size that holds the elements under the grow threshold.
+ */
+static int fit_size(hash_table *table)
+{
+    int size = HASH_TABLE_INITIAL_SIZE;
+    while (0.75 < (float)(table->elementCount) / size)
+        size *= 2;
+    return size;
+}
+
+/**
+ * Resize the table to the smallest size that holds the elements under the grow threshold.
+ */
+void shrink_to_fit(hash_table *table)
+{
+    if (table == NULL)
+        return;
+
+    int size = fit_size(table);
+    if (size != table->size)
+        resize_hash_table(table, size);
+    finish_resize_hash_table(table);
+}
+
+/**
+ * Copy the entries of a range of buckets to a fresh pool and bucket array of the given size.
+ * Returns false if a copy couldn't be allocated.
+ */
+static bool copy_buckets(hash_table *table, bucket **buckets, int first, int end, node_pool *fresh,
+                         bucket **new_buckets, int new_size)
+{
+    for (int i = first; i < end; i++)
+    {
+        for (dll_set_node *cur = buckets[i]->head; cur != NULL; cur = cur->next)
         {
-            // Re-hash to the new size and append to the new bucket.
-            int new_hash = hash_function(cur->key, new_size);
-            append_dll_set(&new_buckets[new_hash]->head, &new_buckets[new_hash]->tail, cur->key, cur->val);
-            cur = cur->next;
+            dll_set_node *copy = create_pool_entry(fresh, cur->key, cur->hash, cur->val);
+            if (copy == NULL)
+                return false;
+            memcpy(copy->payload, cur->payload, table->value_size);
+            link_bucket_node(new_buckets[cur->hash & (new_size - 1)], copy);
         }
-        // Cleanup the old bucket.
-        cleanup_dll_set(old_bucket->head);
-        free(old_bucket);
     }
-    // Free the bucket pointers and set it to the new bucket list.
+    return true;
+}
+
+/**
+ * Shrink the table and copy every entry to a fresh pool.
+ * This gives back the slabs of removed nodes and the key bytes of removed keys,
+ * and packs the remaining nodes together. A running incremental resize is finished by the copy.
+ * Every node pointer returned before is invalidated.
+ * Returns false if the copy couldn't be allocated, the table is left as it was.
+ */
+bool compact_hash_table(hash_table *table)
+{
+    if (table == NULL)
+        return false;
+
+    int size = fit_size(table);
+    bucket **new_buckets = allocate_buckets(size);
+    if (new_buckets == NULL)
+        return false;
+    node_pool fresh;
+    init_node_pool(&fresh, table->value_size);
+
+    // Copy bucket by bucket, so the nodes of a chain end up next to each other.
+    // Nothing of the table changes until every entry is copied.
+    bool copied = copy_buckets(table, table->buckets, 0, table->size, &fresh, new_buckets, size);
+    if (copied && table->old_buckets != NULL)
+        copied = copy_buckets(table, table->old_buckets, table->migrate_index, table->old_size, &fresh, new_buckets,
+                              size);
+    if (!copied)
+    {
+        free_bucket_trees(new_buckets, size);
+        cleanup_node_pool(&fresh);
+        free(new_buckets);
+        return false;
+    }
+
+    if (size != table->size || table->old_buckets != NULL)
+        HASH_STAT_ADD(table, resizes, 1);
+    cleanup_node_pool(&table->pool);
+    table->pool = fresh;
+    free_bucket_trees(table->buckets, table->size);
     free(table->buckets);
+    free_bucket_trees(table->old_buckets, table->old_size);
+    free(table->old_buckets);
+    table->buckets = new_buckets;
+    table->size = size;
+    table->old_buckets = NULL;
+    table->old_size = 0;
+    table->migrate_index = 0;
+
+    // The filter is refilled for the new size, which also drops the bits of removed keys.
+    rebuild_bloom_filter(table);
+    return true;
+}
+
+/**
+ * Hash a group of keys and prefetch everything a lookup of them will touch.
+ * Each stage only reads what the previous one prefetched, so the misses of the
+ * whole group overlap instead of stalling one key at a time.
+ */
+static void prefetch_group(hash_table *table, char **keys, int count, uint64_t *hashes)
+{
+    bucket *buckets[HASH_TABLE_BATCH_GROUP];
+    int mask = table->size - 1;
+
+    for (int i = 0; i < count; i++)
+    {
+        hashes[i] = hash_key(table, keys[i]);
+        HASH_PREFETCH(&table->buckets[hashes[i] & mask]);
+        if (table->bloom != NULL)
+            HASH_PREFETCH(bloom_block_of(table->bloom, hashes[i]));
+    }
+    for (int i = 0; i < count; i++)
+    {
+        buckets[i] = table->buckets[hashes[i] & mask];
+        HASH_PREFETCH(buckets[i]);
+    }
+    for (int i = 0; i < count; i++)
+    {
+        if (buckets[i]->head != NULL)
+            HASH_PREFETCH(buckets[i]->head);
+    }
+    for (int i = 0; i < count; i++)
+    {
+        if (buckets[i]->head != NULL)
+            HASH_PREFETCH(buckets[i]->head->key);
+    }
+}
+
+/**
+ * Search for a batch of keys, results[i] receives the node of keys[i] or NULL.
+ * Every key of the batch must be a valid string.
+ */
+void search_hash_table_batch(hash_table *table, char **keys, int count, dll_set_node **results)
+{
+    if (table == NULL || keys == NULL || results == NULL)
+        return;
+
+    migrate_on_lookup(table);
+
+    uint64_t hashes[HASH_TABLE_BATCH_GROUP];
+    for (int start = 0; start < count; start += HASH_TABLE_BATCH_GROUP)
+    {
+        int group = count - start < HASH_TABLE_BATCH_GROUP ? count - start : HASH_TABLE_BATCH_GROUP;
+        prefetch_group(table, keys + start, group, hashes);
+        for (int i = 0; i < group; i++)
+            results[start + i] = find_hashed(table, keys[start + i], hashes[i]);
+    }
+}
+
+/**
+ * Insert or update a batch of keys, keys[i] is set to vals[i].
+ * Every key of the batch must be a valid string.
+ */
+void set_entries_batch(hash_table *table, char **keys, int *vals, int count)
+{
+    if (table == NULL || keys == NULL || vals == NULL)
+        return;
+
+    migrate_step(table);
+
+    uint64_t hashes[HASH_TABLE_BATCH_GROUP];
+    for (int start = 0; start < count; start += HASH_TABLE_BATCH_GROUP)
+    {
+        int group = count - start < HASH_TABLE_BATCH_GROUP ? count - start : HASH_TABLE_BATCH_GROUP;
+        prefetch_group(table, keys + start, group, hashes);
+
+        // A insert may resize the table, each key finds its bucket again from the hash.
+        for (int i = 0; i < group; i++)
+            set_hashed_entry(table, keys[start + i], hashes[i], vals[start + i]);
+    }
+}
+
+/**
+ * Resize the hash table, the size is rounded up to a power of two.
+ * With incremental resize enabled only the new buckets are allocated here,
+ * the old ones are moved by the following set_entry and search_hash_table calls.
+ */
+void resize_hash_table(hash_table *table, int new_size)
+{
+    if (table == NULL)
+        return;
+
+    // Only one resize can run at a time.
+    finish_resize_hash_table(table);
+
+    // Allocate the new buckets.
+    HASH_STAT_TIMER(start);
+    new_size = round_up_power_of_two(new_size);
+    bucket **new_buckets = allocate_buckets(new_size);
+    if (new_buckets == NULL)
+    {
+        return;
+    }
+    HASH_STAT_ADD(table, resizes, 1);
+    HASH_STAT_ELAPSED(table, start);
+
+    // Swap the arrays, the old one is drained bucket by bucket.
+    table->old_buckets = table->buckets;
+    table->old_size = table->size;
+    table->migrate_index = 0;
     table->buckets = new_buckets;
     table->size = new_size;
+
+    // A incremental resize fills the new filter as the buckets move, without a pause.
+    if (table->incremental)
+    {
+        start_next_bloom_filter(table);
+        return;
+    }
+    finish_resize_hash_table(table);
+    rebuild_bloom_filter(table);
+}
+
+/**
+ * Move every remaining old bucket of a incremental resize.
+ */
+void finish_resize_hash_table(hash_table *table)
+{
+    if (table == NULL)
+        return;
+    while (table->old_buckets != NULL)
+        migrate_step(table);
+}
+
+/**
+ * Enable or disable the incremental resize.
+ * Disabling it finishes any resize that is still running.
+ */
+void set_incremental_resize(hash_table *table, bool enabled)
+{
+    if (table == NULL)
+        return;
+    table->incremental = enabled;
+    if (!enabled)
+        finish_resize_hash_table(table);
+}
+
+/**
+ * Attach a Bloom filter with the given false positive rate, built from the current keys.
+ * Misses rejected by the filter are counted on table->bloom->misses_avoided.
+ * Returns false if the filter couldn't be allocated.
+ */
+bool enable_bloom_filter(hash_table *table, double fp_rate)
+{
+    if (table == NULL)
+        return false;
+
+    disable_bloom_filter(table);
+    table->bloom = malloc(sizeof(bloom_filter));
+    if (table->bloom == NULL)
+        return false;
+    if (!init_bloom_filter(table->bloom, 1, fp_rate))
+    {
+        free(table->bloom);
+        table->bloom = NULL;
+        return false;
+    }
+    rebuild_bloom_filter(table);
+    return table->bloom != NULL;
+}
+
+/**
+ * Drop the Bloom filter of the table.
+ */
+void disable_bloom_filter(hash_table *table)
+{
+    if (table == NULL || table->bloom == NULL)
+        return;
+    drop_next_bloom_filter(table);
+    cleanup_bloom_filter(table->bloom);
+    free(table->bloom);
+    table->bloom = NULL;
+    table->bloom_stale = 0;
 }
 
 /**
@@ -165,11 +984,11 @@ void resize_hash_table(hash_table *table, int new_size)
  */
 dll_set_node *search_hash_table(hash_table *table, char *key)
 {
-    if (table == NULL)
+    if (table == NULL || key == NULL)
         return NULL;
-    int index = hash_function(key, table->size);
-    bucket *cur_bucket = table->buckets[index];
-    return search_dll_set(cur_bucket->head, cur_bucket->tail, key);
+
+    migrate_on_lookup(table);
+    return find_hashed(table, key, hash_key(table, key));
 }
 
 /**
@@ -184,4 +1003,167 @@ void traverse_hash_table(hash_table *table)
         printf("Bucket[%d]: ", i);
         traverse_dll_set(table->buckets[i]->head);
     }
+    if (table->old_buckets == NULL)
+        return;
+    for (int i = table->migrate_index; i < table->old_size; i++)
+    {
+        printf("Old Bucket[%d]: ", i);
+        traverse_dll_set(table->old_buckets[i]->head);
+    }
+}
+
+/**
+ * Get the number of cursor positions, the current buckets plus the old ones.
+ */
+int hash_table_positions(hash_table *table)
+{
+    if (table == NULL)
+        return 0;
+    return table->size + (table->old_buckets != NULL ? table->old_size : 0);
+}
+
+/**
+ * Start a cursor over a range of positions, from first up to but not including end.
+ * The cursor stays open until hash_table_cursor_close.
+ */
+void hash_table_cursor_range(hash_table *table, hash_table_cursor *cursor, int first, int end)
+{
+    if (table != NULL)
+        atomic_fetch_add_explicit(&table->open_cursors, 1, memory_order_relaxed);
+    cursor->table = table;
+    cursor->position = first;
+    cursor->end = end;
+    cursor->node = NULL;
+}
+
+/**
+ * Start a cursor over every entry of the table.
+ * The cursor stays open until hash_table_cursor_close.
+ */
+void hash_table_cursor_begin(hash_table *table, hash_table_cursor *cursor)
+{
+    hash_table_cursor_range(table, cursor, 0, hash_table_positions(table));
+}
+
+/**
+ * Get the next entry of a cursor.
+ * Returns NULL once every entry of the range was returned.
+ */
+dll_set_node *hash_table_cursor_next(hash_table_cursor *cursor)
+{
+    if (cursor == NULL || cursor->table == NULL)
+        return NULL;
+
+    // Keep walking the current chain.
+    if (cursor->node != NULL && cursor->node->next != NULL)
+    {
+        cursor->node = cursor->node->next;
+        return cursor->node;
+    }
+    if (cursor->node != NULL)
+        cursor->position++;
+
+    // Find the next bucket with a entry.
+    hash_table *table = cursor->table;
+    for (; cursor->position < cursor->end; cursor->position++)
+    {
+        int position = cursor->position;
+        bucket *cur_bucket = NULL;
+        if (position < table->size)
+            cur_bucket = table->buckets[position];
+        else if (position - table->size >= table->migrate_index)
+            cur_bucket = table->old_buckets[position - table->size];
+
+        if (cur_bucket != NULL && cur_bucket->head != NULL)
+        {
+            cursor->node = cur_bucket->head;
+            return cursor->node;
+        }
+    }
+    cursor->node = NULL;
+    return NULL;
+}
+
+/**
+ * Close a cursor, lookups move the buckets again once every cursor is closed.
+ * Every cursor must be closed, closing it twice does nothing.
+ */
+void hash_table_cursor_close(hash_table_cursor *cursor)
+{
+    if (cursor == NULL || cursor->table == NULL)
+        return;
+    atomic_fetch_sub_explicit(&cursor->table->open_cursors, 1, memory_order_relaxed);
+    cursor->table = NULL;
+    cursor->node = NULL;
+}
+
+/// @brief Range and accumulator of a parallel scan worker.
+typedef struct ScanWorker
+{
+    hash_table_cursor cursor;
+    hash_table_scan_fn fn;
+    void *acc;
+} scan_worker;
+
+/**
+ * Call the scan function for each entry of the worker range.
+ */
+static void *scan_range(void *arg)
+{
+    scan_worker *worker = arg;
+    dll_set_node *node = NULL;
+    while ((node = hash_table_cursor_next(&worker->cursor)) != NULL)
+        worker->fn(node, worker->acc);
+    return NULL;
+}
+
+/**
+ * Split the buckets in equal ranges and scan each one on its own thread.
+ * Worker i only touches accs[i], the caller merges them after the call.
+ * A range whose thread can't be started is scanned by the calling thread.
+ * The table must not change during the scan.
+ */
+void parallel_scan_hash_table(hash_table *table, int threads, hash_table_scan_fn fn, void **accs)
+{
+    if (table == NULL || threads < 1 || fn == NULL || accs == NULL)
+        return;
+
+    scan_worker *workers = malloc(threads * sizeof(scan_worker));
+    pthread_t *ids = malloc(threads * sizeof(pthread_t));
+    bool *started = malloc(threads * sizeof(bool));
+    if (workers == NULL || ids == NULL || started == NULL)
+    {
+        free(workers);
+        free(ids);
+        free(started);
+        return;
+    }
+
+    int positions = hash_table_positions(table);
+    for (int i = 0; i < threads; i++)
+    {
+        int first = (int)((long long)positions * i / threads);
+        int end = (int)((long long)positions * (i + 1) / threads);
+        hash_table_cursor_range(table, &workers[i].cursor, first, end);
+        workers[i].fn = fn;
+        workers[i].acc = accs[i];
+    }
+
+    // The first range runs on the calling thread.
+    for (int i = 1; i < threads; i++)
+        started[i] = pthread_create(&ids[i], NULL, scan_range, &workers[i]) == 0;
+    scan_range(&workers[0]);
+    for (int i = 1; i < threads; i++)
+    {
+        if (started[i])
+            pthread_join(ids[i], NULL);
+        else
+            scan_range(&workers[i]);
+    }
+    for (int i = 0; i < threads; i++)
+        hash_table_cursor_close(&workers[i].cursor);
+
+    free(workers);
+    free(ids);
+    free(started);
 }
\ No newline at end of file
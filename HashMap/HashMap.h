@@ -1,30 +1,139 @@
 #ifndef HASH_MAP
 #define HASH_MAP
+#include <stdatomic.h>
 #include "DoublyLinkedList.h"
+#include "BloomFilter.h"
+#include "ChainTree.h"
+#include "NodePool.h"
+#include "HashFunctions.h"
 
 /// @brief Bucket for the hashtable. Each bucket is a doubly linked list with head and tail.
+/// Chains longer than HASH_TABLE_TREEIFY get a AVL index on tree, the list stays complete.
 typedef struct HashList
 {
     dll_set_node *head;
     dll_set_node *tail;
+    int count;
+    chain_tree_node *tree;
 } bucket;
 
+/// @brief Number of old buckets moved by each operation during an incremental resize.
+#define HASH_TABLE_MIGRATE_STEP 8
+
+/// @brief Number of keys hashed and prefetched together by the batch calls.
+#define HASH_TABLE_BATCH_GROUP 16
+
+/// @brief Load under which remove_entry halves the table, a quarter of the grow threshold.
+#define HASH_TABLE_SHRINK_LOAD 0.1875
+
+/// @brief Number of buckets of a new table, the size is always a power of two.
+#define HASH_TABLE_INITIAL_SIZE 16
+
+/// @brief Chain length over which a bucket is indexed by a tree.
+#define HASH_TABLE_TREEIFY 8
+
+/// @brief Chain length under which the tree of a bucket is dropped.
+#define HASH_TABLE_UNTREEIFY 6
+
+/// @brief Operation counters of a table, only updated when built with HASH_MAP_STATS.
+typedef struct HashTableCounters
+{
+    unsigned long long lookups;
+    unsigned long long probes;
+    unsigned long long key_compares;
+    unsigned long long resizes;
+    unsigned long long resize_ns;
+} hash_table_counters;
+
+#ifdef HASH_MAP_STATS
+#define HASH_STAT_ADD(table, field, amount) ((table)->counters.field += (amount))
+#else
+#define HASH_STAT_ADD(table, field, amount) ((void)(table))
+#endif
+
 /// @brief The hashtable and it's data.
+/// Each node caches the full hash of its key, the bucket is its low bits.
+/// Nodes and keys come from the table pool and are released together with it.
+/// Every node carries value_size bytes of payload next to the int value.
+/// While an incremental resize is running the old buckets are kept until
+/// every bucket below old_size has been moved to the new array.
+/// A optional Bloom filter of the cached hashes answers most misses before any bucket is read,
+/// bloom_stale counts the removed keys still set on it. During an incremental resize bloom_next,
+/// sized for the new array, is filled as the buckets move and replaces bloom once they all did.
+/// open_cursors counts the cursors not closed yet, lookups don't move buckets while it isn't 0.
+/// It is atomic so cursors can be opened and closed from several threads.
 typedef struct HashTable
 {
     bucket **buckets;
     int size;
     int elementCount;
+    bucket **old_buckets;
+    int old_size;
+    int migrate_index;
+    bool incremental;
+    node_pool pool;
+    hash_key_function hash;
+    size_t value_size;
+    hash_table_counters counters;
+    bloom_filter *bloom;
+    int bloom_stale;
+    bloom_filter *bloom_next;
+    int bloom_next_stale;
+    atomic_int open_cursors;
 } hash_table;
 
+/// @brief Resumable position of a walk over the entries of a table.
+/// Positions below size are the current buckets, the ones after are the old buckets
+/// of a incremental resize. The table must not change while a cursor is in use,
+/// lookups can still run: they leave the buckets in place until every cursor is closed.
+typedef struct HashTableCursor
+{
+    hash_table *table;
+    int position;
+    int end;
+    dll_set_node *node;
+} hash_table_cursor;
+
+/// @brief Called by a parallel scan for each entry, with the accumulator of the worker.
+typedef void (*hash_table_scan_fn)(dll_set_node *node, void *acc);
+
 hash_table *create_hash_table();
+hash_table *create_hash_table_with_hash(hash_key_function hash);
+hash_table *create_hash_table_with_payload(size_t value_size);
+hash_table *create_hash_table_with_options(hash_key_function hash, size_t value_size);
 dll_set_node *search_hash_table(hash_table *table, char *key);
+void *search_hash_table_payload(hash_table *table, char *key);
+void search_hash_table_batch(hash_table *table, char **keys, int count, dll_set_node **results);
 
 int hash_function(char *key, int size);
+uint64_t hash_key(hash_table *table, char *key);
 
 void cleanup_table(hash_table *table);
 void set_entry(hash_table *table, char *key, int val);
+void *set_entry_payload(hash_table *table, char *key, const void *value);
+dll_set_node *get_or_insert_node(hash_table *table, char *key, int default_val, bool *inserted);
+dll_set_node *get_or_insert_hashed(hash_table *table, char *key, uint64_t hash, int default_val, bool *inserted);
+int *get_or_insert(hash_table *table, char *key, int default_val, bool *inserted);
+int *add_to_entry(hash_table *table, char *key, int delta);
+void set_entries_batch(hash_table *table, char **keys, int *vals, int count);
 void resize_hash_table(hash_table *table, int new_size);
+bool remove_entry(hash_table *table, char *key);
+void clear_hash_table(hash_table *table);
+void shrink_to_fit(hash_table *table);
+bool compact_hash_table(hash_table *table);
+void set_incremental_resize(hash_table *table, bool enabled);
+bool enable_bloom_filter(hash_table *table, double fp_rate);
+void disable_bloom_filter(hash_table *table);
+void finish_resize_hash_table(hash_table *table);
 void traverse_hash_table(hash_table *table);
 
+/// Every cursor must be closed with hash_table_cursor_close. Until then lookups stop moving
+/// the old buckets, so a cursor left open slows every lookup until writes finish the resize.
+void hash_table_cursor_begin(hash_table *table, hash_table_cursor *cursor);
+void hash_table_cursor_range(hash_table *table, hash_table_cursor *cursor, int first, int end);
+dll_set_node *hash_table_cursor_next(hash_table_cursor *cursor);
+void hash_table_cursor_close(hash_table_cursor *cursor);
+int hash_table_positions(hash_table *table);
+void parallel_scan_hash_table(hash_table *table, int threads, hash_table_scan_fn fn, void **accs);
+
 #endif
\ No newline at end of file
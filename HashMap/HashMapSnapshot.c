@@ -0,0 +1,229 @@
+#include "HashMapSnapshot.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * Round a offset up to a multiple of 8.
+ */
+static uint64_t align8(uint64_t offset)
+{
+    return (offset + 7) & ~(uint64_t)7;
+}
+
+/**
+ * Append every node of a chain to the snapshot buffer.
+ * Snapshots always use the default word hash, so the cached hash is only reused when it matches.
+ */
+static void add_chain(hash_table *table, dll_set_node *node, unsigned char *buffer, const hash_snapshot_header *header,
+                      uint64_t *count, uint64_t *key_used)
+{
+    uint32_t *index = (uint32_t *)(buffer + header->index_offset);
+    hash_snapshot_entry *entries = (hash_snapshot_entry *)(buffer + header->entries_offset);
+    uint64_t mask = header->index_size - 1;
+
+    for (; node != NULL; node = node->next)
+    {
+        size_t len = strlen(node->key);
+        hash_snapshot_entry *entry = &entries[*count];
+        entry->hash = table->hash == hash_bytes_words ? node->hash : hash_bytes_words(node->key, len);
+        entry->key_offset = header->keys_offset + *key_used;
+        entry->key_len = (uint32_t)len;
+        entry->val = node->val;
+        memcpy(buffer + entry->key_offset, node->key, len + 1);
+        *key_used += len + 1;
+
+        // Linear probing, the index is at most half full.
+        uint64_t slot = entry->hash & mask;
+        while (index[slot] != 0)
+            slot = (slot + 1) & mask;
+        index[slot] = (uint32_t)(++*count);
+    }
+}
+
+/**
+ * Save the table to a snapshot file.
+ * The whole file is built in memory and written at once.
+ * Returns false if the table can't be saved or the file can't be written.
+ */
+bool save_hash_snapshot(hash_table *table, const char *path)
+{
+    if (table == NULL || path == NULL)
+        return false;
+
+    // Count the key bytes of the current and the not yet moved buckets.
+    uint64_t key_bytes = 0;
+    for (int i = 0; i < table->size; i++)
+        for (dll_set_node *cur = table->buckets[i]->head; cur != NULL; cur = cur->next)
+            key_bytes += strlen(cur->key) + 1;
+    for (int i = table->migrate_index; table->old_buckets != NULL && i < table->old_size; i++)
+        for (dll_set_node *cur = table->old_buckets[i]->head; cur != NULL; cur = cur->next)
+            key_bytes += strlen(cur->key) + 1;
+
+    // Lay out the file: header, index, entries and the key blob.
+    hash_snapshot_header header;
+    memset(&header, 0, sizeof(header));
+    header.magic = HASH_SNAPSHOT_MAGIC;
+    header.version = HASH_SNAPSHOT_VERSION;
+    header.byte_order = HASH_SNAPSHOT_BYTE_ORDER;
+    header.entry_count = (uint64_t)table->elementCount;
+    header.index_size = 16;
+    while (header.index_size < header.entry_count * 2)
+        header.index_size *= 2;
+    header.index_offset = sizeof(hash_snapshot_header);
+    header.entries_offset = align8(header.index_offset + header.index_size * sizeof(uint32_t));
+    header.keys_offset = header.entries_offset + header.entry_count * sizeof(hash_snapshot_entry);
+    header.file_size = header.keys_offset + key_bytes;
+
+    unsigned char *buffer = calloc(1, header.file_size);
+    if (buffer == NULL)
+        return false;
+
+    uint64_t count = 0;
+    uint64_t key_used = 0;
+    for (int i = 0; i < table->size; i++)
+        add_chain(table, table->buckets[i]->head, buffer, &header, &count, &key_used);
+    for (int i = table->migrate_index; table->old_buckets != NULL && i < table->old_size; i++)
+        add_chain(table, table->old_buckets[i]->head, buffer, &header, &count, &key_used);
+
+    header.checksum = hash_bytes_words((const char *)buffer + sizeof(header), header.file_size - sizeof(header));
+    memcpy(buffer, &header, sizeof(header));
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        free(buffer);
+        return false;
+    }
+    bool written = fwrite(buffer, 1, header.file_size, file) == header.file_size;
+    written = fclose(file) == 0 && written;
+    free(buffer);
+    return written;
+}
+
+/**
+ * Check that the header describes a complete file of this version.
+ */
+static bool valid_header(const hash_snapshot_header *header, size_t length)
+{
+    if (header->magic != HASH_SNAPSHOT_MAGIC || header->version != HASH_SNAPSHOT_VERSION ||
+        header->byte_order != HASH_SNAPSHOT_BYTE_ORDER)
+        return false;
+
+    // A truncated or extended file doesn't match the recorded size.
+    if (header->file_size != length)
+        return false;
+
+    // The index size must be a power of two with a empty slot left to end every probe.
+    if (header->index_size == 0 || (header->index_size & (header->index_size - 1)) != 0 ||
+        header->index_size <= header->entry_count || header->entry_count > UINT32_MAX)
+        return false;
+
+    // The sections must follow each other inside the file.
+    // Every size is bounded by the space left before it's multiplied, so nothing wraps.
+    if (header->index_offset != sizeof(hash_snapshot_header) ||
+        header->index_size > (length - header->index_offset) / sizeof(uint32_t))
+        return false;
+    if (header->entries_offset < header->index_offset + header->index_size * sizeof(uint32_t) ||
+        header->entries_offset > length ||
+        header->entry_count > (length - header->entries_offset) / sizeof(hash_snapshot_entry))
+        return false;
+    return header->keys_offset == header->entries_offset + header->entry_count * sizeof(hash_snapshot_entry);
+}
+
+/**
+ * Map a snapshot file read only.
+ * The header is always validated, the checksum of the whole file only if asked.
+ * Returns NULL if the file can't be mapped or isn't a valid snapshot.
+ */
+hash_snapshot *open_hash_snapshot(const char *path, bool verify_checksum)
+{
+    if (path == NULL)
+        return NULL;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(hash_snapshot_header))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    // The mapping stays valid after the descriptor is closed.
+    void *base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        return NULL;
+
+    const hash_snapshot_header *header = base;
+    bool valid = valid_header(header, st.st_size);
+    if (valid && verify_checksum)
+        valid = hash_bytes_words((const char *)base + sizeof(*header), st.st_size - sizeof(*header)) == header->checksum;
+
+    hash_snapshot *snapshot = valid ? malloc(sizeof(hash_snapshot)) : NULL;
+    if (snapshot == NULL)
+    {
+        munmap(base, st.st_size);
+        return NULL;
+    }
+    snapshot->base = base;
+    snapshot->length = st.st_size;
+    snapshot->header = header;
+    snapshot->index = (const uint32_t *)(snapshot->base + header->index_offset);
+    snapshot->entries = (const hash_snapshot_entry *)(snapshot->base + header->entries_offset);
+    return snapshot;
+}
+
+/**
+ * Search for a key directly on the mapped file and copy its value.
+ * Returns false if the key isn't on the snapshot.
+ */
+bool search_hash_snapshot(hash_snapshot *snapshot, char *key, int *val)
+{
+    if (snapshot == NULL || key == NULL)
+        return false;
+
+    size_t len = strlen(key);
+    uint64_t hash = hash_bytes_words(key, len);
+    uint64_t mask = snapshot->header->index_size - 1;
+
+    // Walk the probe sequence until a empty slot, at most once around the index.
+    uint64_t slot = hash & mask;
+    for (uint64_t probes = 0; probes <= mask && snapshot->index[slot] != 0; probes++, slot = (slot + 1) & mask)
+    {
+        uint32_t number = snapshot->index[slot];
+        if (number > snapshot->header->entry_count)
+            return false;
+        const hash_snapshot_entry *entry = &snapshot->entries[number - 1];
+        if (entry->hash != hash || entry->key_len != len)
+            continue;
+        // The key and its NUL must sit in the key blob, checked without adding to the offset.
+        if (entry->key_offset < snapshot->header->keys_offset || entry->key_offset >= snapshot->length ||
+            len > snapshot->length - entry->key_offset - 1)
+            return false;
+        if (memcmp(snapshot->base + entry->key_offset, key, len) == 0)
+        {
+            if (val != NULL)
+                *val = entry->val;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Unmap the snapshot and free it.
+ */
+void close_hash_snapshot(hash_snapshot *snapshot)
+{
+    if (snapshot == NULL)
+        return;
+    munmap((void *)snapshot->base, snapshot->length);
+    free(snapshot);
+}
\ No newline at end of file
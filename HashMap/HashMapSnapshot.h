@@ -0,0 +1,54 @@
+#ifndef HASH_MAP_SNAPSHOT
+#define HASH_MAP_SNAPSHOT
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "HashMap.h"
+
+#define HASH_SNAPSHOT_MAGIC 0x50414e534d485348ULL
+#define HASH_SNAPSHOT_VERSION 1
+#define HASH_SNAPSHOT_BYTE_ORDER 0x01020304
+
+/// @brief Fixed header at the start of a snapshot file.
+/// Every offset is relative to the start of the file, so the file can be mapped anywhere.
+/// The checksum is the word hash of every byte after the header.
+typedef struct HashSnapshotHeader
+{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t file_size;
+    uint64_t entry_count;
+    uint64_t index_size;
+    uint64_t index_offset;
+    uint64_t entries_offset;
+    uint64_t keys_offset;
+    uint64_t checksum;
+} hash_snapshot_header;
+
+/// @brief Entry of a snapshot, the key is NUL terminated inside the key blob.
+typedef struct HashSnapshotEntry
+{
+    uint64_t hash;
+    uint64_t key_offset;
+    uint32_t key_len;
+    int32_t val;
+} hash_snapshot_entry;
+
+/// @brief Read only view of a mapped snapshot.
+/// The index is a linear probing table of entry numbers plus one, 0 marks a empty slot.
+typedef struct HashSnapshot
+{
+    const unsigned char *base;
+    size_t length;
+    const hash_snapshot_header *header;
+    const uint32_t *index;
+    const hash_snapshot_entry *entries;
+} hash_snapshot;
+
+bool save_hash_snapshot(hash_table *table, const char *path);
+hash_snapshot *open_hash_snapshot(const char *path, bool verify_checksum);
+bool search_hash_snapshot(hash_snapshot *snapshot, char *key, int *val);
+void close_hash_snapshot(hash_snapshot *snapshot);
+
+#endif
\ No newline at end of file
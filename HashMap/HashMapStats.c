@@ -0,0 +1,113 @@
+#include "HashMapStats.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * Count the length of a bucket chain into the histogram.
+ * Returns the count of tree nodes indexing the bucket.
+ */
+static int count_bucket(hash_table_stats *stats, bucket *cur_bucket, int *non_empty)
+{
+    int length = 0;
+    for (dll_set_node *cur = cur_bucket->head; cur != NULL; cur = cur->next)
+        length++;
+
+    stats->chain_histogram[length < HASH_STATS_HISTOGRAM ? length : HASH_STATS_HISTOGRAM - 1]++;
+    if (length > stats->max_chain)
+        stats->max_chain = length;
+    if (length > 0)
+        (*non_empty)++;
+    if (cur_bucket->tree == NULL)
+        return 0;
+    stats->tree_buckets++;
+    return length;
+}
+
+/**
+ * Fill the stats of a table.
+ * Walks every bucket, so the cost is linear on the size of the table.
+ */
+void get_hash_table_stats(hash_table *table, hash_table_stats *stats)
+{
+    if (stats == NULL)
+        return;
+    memset(stats, 0, sizeof(hash_table_stats));
+    if (table == NULL)
+        return;
+
+    stats->size = table->size;
+    stats->elementCount = table->elementCount;
+    stats->load_factor = (double)table->elementCount / table->size;
+
+    // The old buckets of a running resize are part of the shape too.
+    int non_empty = 0;
+    size_t tree_nodes = 0;
+    for (int i = 0; i < table->size; i++)
+        tree_nodes += count_bucket(stats, table->buckets[i], &non_empty);
+    for (int i = table->migrate_index; table->old_buckets != NULL && i < table->old_size; i++)
+        tree_nodes += count_bucket(stats, table->old_buckets[i], &non_empty);
+    stats->avg_chain = non_empty > 0 ? (double)table->elementCount / non_empty : 0;
+
+    // The table, both bucket arrays, the bucket trees and every block of the pool.
+    size_t bucket_bytes = sizeof(bucket *) + sizeof(bucket);
+    stats->memory_bytes = sizeof(hash_table) + table->size * bucket_bytes + table->pool.allocated_bytes +
+                          tree_nodes * sizeof(chain_tree_node);
+    if (table->old_buckets != NULL)
+        stats->memory_bytes += table->old_size * bucket_bytes;
+    if (table->bloom != NULL)
+    {
+        stats->memory_bytes += sizeof(bloom_filter) + bloom_filter_bytes(table->bloom);
+        stats->bloom_misses_avoided = table->bloom->misses_avoided;
+    }
+    if (table->bloom_next != NULL)
+        stats->memory_bytes += sizeof(bloom_filter) + bloom_filter_bytes(table->bloom_next);
+    stats->bytes_per_entry = table->elementCount > 0 ? (double)stats->memory_bytes / table->elementCount : 0;
+
+#ifdef HASH_MAP_STATS
+    stats->counters_enabled = true;
+#endif
+    stats->counters = table->counters;
+    if (stats->counters.lookups > 0)
+    {
+        stats->probes_per_lookup = (double)stats->counters.probes / stats->counters.lookups;
+        stats->compares_per_lookup = (double)stats->counters.key_compares / stats->counters.lookups;
+    }
+}
+
+/**
+ * Set every counter of the table back to zero.
+ */
+void reset_hash_table_counters(hash_table *table)
+{
+    if (table == NULL)
+        return;
+    memset(&table->counters, 0, sizeof(hash_table_counters));
+}
+
+/**
+ * Print the stats in a readable form.
+ */
+void print_hash_table_stats(const hash_table_stats *stats)
+{
+    if (stats == NULL)
+        return;
+    printf("Size: %d Elements: %d Load: %.3f\n", stats->size, stats->elementCount, stats->load_factor);
+    printf("Chains: max %d, average %.2f over non empty buckets, %d indexed by a tree\n", stats->max_chain,
+           stats->avg_chain, stats->tree_buckets);
+    for (int i = 0; i < HASH_STATS_HISTOGRAM; i++)
+    {
+        if (stats->chain_histogram[i] != 0)
+            printf("  %s%d: %d\n", i == HASH_STATS_HISTOGRAM - 1 ? ">=" : "", i, stats->chain_histogram[i]);
+    }
+    printf("Memory: %zu bytes, %.1f per entry\n", stats->memory_bytes, stats->bytes_per_entry);
+    if (stats->bloom_misses_avoided != 0)
+        printf("Bloom filter: %llu misses answered without a bucket\n", stats->bloom_misses_avoided);
+    if (!stats->counters_enabled)
+    {
+        printf("Counters: disabled, build with HASH_MAP_STATS\n");
+        return;
+    }
+    printf("Lookups: %llu, %.2f probes and %.2f key compares each\n", stats->counters.lookups,
+           stats->probes_per_lookup, stats->compares_per_lookup);
+    printf("Resizes: %llu, %.3f ms total\n", stats->counters.resizes, stats->counters.resize_ns / 1e6);
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#ifndef HASH_MAP_STATS_H
+#define HASH_MAP_STATS_H
+#include <stdbool.h>
+#include <stddef.h>
+#include "HashMap.h"
+
+/// @brief Chain lengths counted one by one, the last slot holds every longer chain.
+#define HASH_STATS_HISTOGRAM 16
+
+/// @brief Snapshot of the shape and the counters of a table.
+/// The shape is measured on each call, the counters are only filled when built with HASH_MAP_STATS.
+typedef struct HashTableStats
+{
+    int size;
+    int elementCount;
+    double load_factor;
+    int chain_histogram[HASH_STATS_HISTOGRAM];
+    int max_chain;
+    double avg_chain;
+    int tree_buckets;
+    size_t memory_bytes;
+    double bytes_per_entry;
+    bool counters_enabled;
+    hash_table_counters counters;
+    double probes_per_lookup;
+    double compares_per_lookup;
+    unsigned long long bloom_misses_avoided;
+} hash_table_stats;
+
+void get_hash_table_stats(hash_table *table, hash_table_stats *stats);
+void reset_hash_table_counters(hash_table *table);
+void print_hash_table_stats(const hash_table_stats *stats);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,214 @@
+#ifndef INT_HASH_MAP
+#define INT_HASH_MAP
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "HashFunctions.h"
+#include "HashMapStats.h"
+
+/// @brief Generate a open addressing map from integer keys to values.
+/// DEFINE_INT_HASH_MAP(id_map, uint64_t, int) defines the id_map type and create_id_map,
+/// set_id_map_entry, search_id_map, get_or_insert_id_map, remove_id_map_entry, resize_id_map,
+/// shrink_id_map_to_fit, get_id_map_stats and cleanup_id_map.
+/// Keys are stored inline and compared with ==, the slots are probed linearly and removal
+/// shifts the following entries back, so there are no tombstones.
+/// Sizes are powers of two and follow the grow and shrink thresholds of hash_table.
+#define DEFINE_INT_HASH_MAP(name, key_type, val_type)                                                  \
+    typedef struct                                                                                     \
+    {                                                                                                  \
+        key_type key;                                                                                  \
+        val_type val;                                                                                  \
+    } name##_entry;                                                                                    \
+                                                                                                       \
+    typedef struct                                                                                     \
+    {                                                                                                  \
+        name##_entry *entries;                                                                         \
+        unsigned char *used;                                                                           \
+        int size;                                                                                      \
+        int elementCount;                                                                              \
+    } name;                                                                                            \
+                                                                                                       \
+    static inline int name##_home(const name *map, key_type key)                                       \
+    {                                                                                                  \
+        return (int)(hash_u64((uint64_t)key) & (uint64_t)(map->size - 1));                             \
+    }                                                                                                  \
+                                                                                                       \
+    /* Find the slot of a key, or the empty slot that ends its probe sequence. */                      \
+    static inline int name##_find_slot(const name *map, key_type key)                                  \
+    {                                                                                                  \
+        int mask = map->size - 1;                                                                      \
+        int slot = name##_home(map, key);                                                              \
+        while (map->used[slot] && map->entries[slot].key != key)                                       \
+            slot = (slot + 1) & mask;                                                                  \
+        return slot;                                                                                   \
+    }                                                                                                  \
+                                                                                                       \
+    static inline bool name##_allocate(name *map, int size)                                            \
+    {                                                                                                  \
+        map->entries = malloc(size * sizeof(name##_entry));                                            \
+        map->used = calloc(size, 1);                                                                   \
+        if (map->entries == NULL || map->used == NULL)                                                 \
+        {                                                                                              \
+            free(map->entries);                                                                        \
+            free(map->used);                                                                           \
+            return false;                                                                              \
+        }                                                                                              \
+        map->size = size;                                                                              \
+        return true;                                                                                   \
+    }                                                                                                  \
+                                                                                                       \
+    static inline name *create_##name()                                                                \
+    {                                                                                                  \
+        name *map = malloc(sizeof(name));                                                              \
+        if (map == NULL)                                                                               \
+            return NULL;                                                                               \
+        map->elementCount = 0;                                                                         \
+        if (!name##_allocate(map, HASH_TABLE_INITIAL_SIZE))                                            \
+        {                                                                                              \
+            free(map);                                                                                 \
+            return NULL;                                                                               \
+        }                                                                                              \
+        return map;                                                                                    \
+    }                                                                                                  \
+                                                                                                       \
+    /* Rehash every entry to a new array, the size is rounded up to a power of two. */                 \
+    static inline bool resize_##name(name *map, int new_size)                                          \
+    {                                                                                                  \
+        int size = HASH_TABLE_INITIAL_SIZE;                                                            \
+        while (size < new_size || size <= map->elementCount)                                           \
+            size *= 2;                                                                                 \
+        name old = *map;                                                                               \
+        if (!name##_allocate(map, size))                                                               \
+        {                                                                                              \
+            *map = old;                                                                                \
+            return false;                                                                              \
+        }                                                                                              \
+        for (int i = 0; i < old.size; i++)                                                             \
+        {                                                                                              \
+            if (!old.used[i])                                                                          \
+                continue;                                                                              \
+            int slot = name##_find_slot(map, old.entries[i].key);                                      \
+            map->entries[slot] = old.entries[i];                                                       \
+            map->used[slot] = 1;                                                                       \
+        }                                                                                              \
+        free(old.entries);                                                                             \
+        free(old.used);                                                                                \
+        return true;                                                                                   \
+    }                                                                                                  \
+                                                                                                       \
+    static inline val_type *search_##name(name *map, key_type key)                                     \
+    {                                                                                                  \
+        if (map == NULL)                                                                               \
+            return NULL;                                                                               \
+        int slot = name##_find_slot(map, key);                                                         \
+        return map->used[slot] ? &map->entries[slot].val : NULL;                                       \
+    }                                                                                                  \
+                                                                                                       \
+    /* Get the value slot of a key in one probe, inserting default_val if missing. */                  \
+    static inline val_type *get_or_insert_##name(name *map, key_type key, val_type default_val,        \
+                                                 bool *inserted)                                       \
+    {                                                                                                  \
+        if (inserted != NULL)                                                                          \
+            *inserted = false;                                                                         \
+        if (map == NULL)                                                                               \
+            return NULL;                                                                               \
+        int slot = name##_find_slot(map, key);                                                         \
+        if (map->used[slot])                                                                           \
+            return &map->entries[slot].val;                                                            \
+                                                                                                       \
+        /* Grow first, so the slot of the new entry stays valid. */                                    \
+        if (0.75 < (float)(map->elementCount + 1) / map->size)                                         \
+        {                                                                                              \
+            if (!resize_##name(map, map->size * 2))                                                    \
+                return NULL;                                                                           \
+            slot = name##_find_slot(map, key);                                                         \
+        }                                                                                              \
+        map->entries[slot].key = key;                                                                  \
+        map->entries[slot].val = default_val;                                                          \
+        map->used[slot] = 1;                                                                           \
+        map->elementCount++;                                                                           \
+        if (inserted != NULL)                                                                          \
+            *inserted = true;                                                                          \
+        return &map->entries[slot].val;                                                                \
+    }                                                                                                  \
+                                                                                                       \
+    static inline bool set_##name##_entry(name *map, key_type key, val_type val)                       \
+    {                                                                                                  \
+        val_type *slot = get_or_insert_##name(map, key, val, NULL);                                    \
+        if (slot == NULL)                                                                              \
+            return false;                                                                              \
+        *slot = val;                                                                                   \
+        return true;                                                                                   \
+    }                                                                                                  \
+                                                                                                       \
+    /* Remove a key, moving back every following entry that can get closer to its home. */             \
+    static inline bool remove_##name##_entry(name *map, key_type key)                                  \
+    {                                                                                                  \
+        if (map == NULL)                                                                               \
+            return false;                                                                              \
+        int mask = map->size - 1;                                                                      \
+        int hole = name##_find_slot(map, key);                                                         \
+        if (!map->used[hole])                                                                          \
+            return false;                                                                              \
+        for (int next = (hole + 1) & mask; map->used[next]; next = (next + 1) & mask)                  \
+        {                                                                                              \
+            int home = name##_home(map, map->entries[next].key);                                       \
+            if (((next - home) & mask) >= ((next - hole) & mask))                                      \
+            {                                                                                          \
+                map->entries[hole] = map->entries[next];                                               \
+                hole = next;                                                                           \
+            }                                                                                          \
+        }                                                                                              \
+        map->used[hole] = 0;                                                                           \
+        map->elementCount--;                                                                           \
+        if (map->size > HASH_TABLE_INITIAL_SIZE &&                                                     \
+            (float)(map->elementCount) / map->size < HASH_TABLE_SHRINK_LOAD)                           \
+            resize_##name(map, map->size / 2);                                                         \
+        return true;                                                                                   \
+    }                                                                                                  \
+                                                                                                       \
+    static inline bool shrink_##name##_to_fit(name *map)                                               \
+    {                                                                                                  \
+        int size = HASH_TABLE_INITIAL_SIZE;                                                            \
+        while (0.75 < (float)(map->elementCount) / size)                                               \
+            size *= 2;                                                                                 \
+        return size == map->size || resize_##name(map, size);                                          \
+    }                                                                                                  \
+                                                                                                       \
+    /* The chain histogram counts the probes each entry needs, its distance from home plus one. */     \
+    static inline void get_##name##_stats(name *map, hash_table_stats *stats)                          \
+    {                                                                                                  \
+        memset(stats, 0, sizeof(hash_table_stats));                                                   \
+        if (map == NULL)                                                                               \
+            return;                                                                                    \
+        stats->size = map->size;                                                                       \
+        stats->elementCount = map->elementCount;                                                       \
+        stats->load_factor = (double)map->elementCount / map->size;                                    \
+        long long total = 0;                                                                           \
+        for (int i = 0; i < map->size; i++)                                                            \
+        {                                                                                              \
+            if (!map->used[i])                                                                         \
+                continue;                                                                              \
+            int probes = ((i - name##_home(map, map->entries[i].key)) & (map->size - 1)) + 1;          \
+            stats->chain_histogram[probes < HASH_STATS_HISTOGRAM ? probes : HASH_STATS_HISTOGRAM - 1]++; \
+            if (probes > stats->max_chain)                                                             \
+                stats->max_chain = probes;                                                             \
+            total += probes;                                                                           \
+        }                                                                                              \
+        stats->avg_chain = map->elementCount > 0 ? (double)total / map->elementCount : 0;              \
+        stats->memory_bytes = sizeof(name) + map->size * (sizeof(name##_entry) + 1);                   \
+        stats->bytes_per_entry =                                                                       \
+            map->elementCount > 0 ? (double)stats->memory_bytes / map->elementCount : 0;               \
+    }                                                                                                  \
+                                                                                                       \
+    static inline void cleanup_##name(name *map)                                                       \
+    {                                                                                                  \
+        if (map == NULL)                                                                               \
+            return;                                                                                    \
+        free(map->entries);                                                                            \
+        free(map->used);                                                                               \
+        free(map);                                                                                     \
+    }
+
+#endif
\ No newline at end of file
@@ -0,0 +1,240 @@
+#include "LRUCache.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Get the cache entry on the payload of a node.
+ */
+static cache_entry *entry_of(dll_set_node *node)
+{
+    return (cache_entry *)node->payload;
+}
+
+/**
+ * Link a node just older than the given one, NULL links it as the newest.
+ */
+static void link_before(lru_cache *cache, dll_set_node *node, dll_set_node *newer)
+{
+    cache_entry *entry = entry_of(node);
+    entry->newer = newer;
+    entry->older = newer != NULL ? entry_of(newer)->older : cache->newest;
+    if (entry->older != NULL)
+        entry_of(entry->older)->newer = node;
+    else
+        cache->oldest = node;
+    if (newer != NULL)
+        entry_of(newer)->older = node;
+    else
+        cache->newest = node;
+}
+
+/**
+ * Link a node as the newest of the recency list.
+ */
+static void link_newest(lru_cache *cache, dll_set_node *node)
+{
+    link_before(cache, node, NULL);
+}
+
+/**
+ * Unlink a node from the recency list, moving the clock hand off it.
+ */
+static void unlink_recency(lru_cache *cache, dll_set_node *node)
+{
+    cache_entry *entry = entry_of(node);
+    if (cache->hand == node)
+        cache->hand = entry->newer;
+    if (entry->newer != NULL)
+        entry_of(entry->newer)->older = entry->older;
+    else
+        cache->newest = entry->older;
+    if (entry->older != NULL)
+        entry_of(entry->older)->newer = entry->newer;
+    else
+        cache->oldest = entry->newer;
+    entry->newer = NULL;
+    entry->older = NULL;
+}
+
+/**
+ * Pick the entry to evict.
+ * CLOCK clears the mark of every marked entry it passes, wrapping from the newest to the oldest,
+ * and leaves the hand on the entry after the victim so the next sweep resumes there.
+ * At most every entry is passed once, so some entry is always found.
+ */
+static dll_set_node *eviction_victim(lru_cache *cache)
+{
+    if (cache->policy == CACHE_LRU)
+        return cache->oldest;
+
+    dll_set_node *node = cache->hand != NULL ? cache->hand : cache->oldest;
+    while (node != NULL && entry_of(node)->referenced)
+    {
+        entry_of(node)->referenced = false;
+        node = entry_of(node)->newer != NULL ? entry_of(node)->newer : cache->oldest;
+    }
+    if (node != NULL)
+        cache->hand = entry_of(node)->newer != NULL ? entry_of(node)->newer : cache->oldest;
+    return node;
+}
+
+/**
+ * Remove a node from the list and the table.
+ */
+static void drop_entry(lru_cache *cache, dll_set_node *node)
+{
+    unlink_recency(cache, node);
+    cache->bytes -= entry_of(node)->bytes;
+    remove_entry(cache->table, node->key);
+}
+
+/**
+ * Check if one more entry of the given cost would go over a limit.
+ */
+static bool over_capacity(lru_cache *cache, size_t bytes)
+{
+    if (cache->max_entries != 0 && (size_t)cache->table->elementCount > cache->max_entries)
+        return true;
+    return cache->max_bytes != 0 && cache->bytes + bytes > cache->max_bytes;
+}
+
+/**
+ * Create a empty cache.
+ * max_entries and max_bytes bound the cache, 0 leaves a limit out.
+ * Returns NULL if the allocation fails.
+ */
+lru_cache *create_lru_cache(size_t max_entries, size_t max_bytes, size_t value_size, cache_policy policy)
+{
+    lru_cache *cache = malloc(sizeof(lru_cache));
+    if (cache == NULL)
+        return NULL;
+
+    cache->table = create_hash_table_with_payload(sizeof(cache_entry) + value_size);
+    if (cache->table == NULL)
+    {
+        free(cache);
+        return NULL;
+    }
+    cache->policy = policy;
+    cache->value_size = value_size;
+    cache->max_entries = max_entries;
+    cache->max_bytes = max_bytes;
+    cache->bytes = 0;
+    cache->newest = NULL;
+    cache->oldest = NULL;
+    cache->hand = NULL;
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->evictions = 0;
+    return cache;
+}
+
+/**
+ * Search for a key and mark it as used.
+ * LRU moves the entry to the front, CLOCK only sets its mark so hits don't write the list.
+ * Returns the value of the entry, NULL if it isn't cached.
+ */
+void *cache_get(lru_cache *cache, char *key)
+{
+    if (cache == NULL || key == NULL)
+        return NULL;
+
+    dll_set_node *node = search_hash_table(cache->table, key);
+    if (node == NULL)
+    {
+        cache->misses++;
+        return NULL;
+    }
+    cache->hits++;
+
+    cache_entry *entry = entry_of(node);
+    if (cache->policy == CACHE_CLOCK)
+        entry->referenced = true;
+    else if (cache->newest != node)
+    {
+        unlink_recency(cache, node);
+        link_newest(cache, node);
+    }
+    return entry->value;
+}
+
+/**
+ * Insert or update a key, copying value_size bytes of value.
+ * A new entry evicts the least recently used ones until the cache is under its limits again,
+ * a entry bigger than max_bytes alone is still kept.
+ * Returns the cached value, NULL if the key couldn't be inserted.
+ */
+void *cache_put(lru_cache *cache, char *key, const void *value)
+{
+    if (cache == NULL || key == NULL || value == NULL)
+        return NULL;
+
+    bool inserted = false;
+    dll_set_node *node = get_or_insert_node(cache->table, key, 0, &inserted);
+    if (node == NULL)
+        return NULL;
+
+    cache_entry *entry = entry_of(node);
+    memcpy(entry->value, value, cache->value_size);
+    if (!inserted)
+    {
+        if (cache->policy == CACHE_CLOCK)
+            entry->referenced = true;
+        else if (cache->newest != node)
+        {
+            unlink_recency(cache, node);
+            link_newest(cache, node);
+        }
+        return entry->value;
+    }
+
+    // Short keys live in the node, only the longer ones take arena bytes.
+    size_t len = strlen(key);
+    entry->bytes = cache->table->pool.node_size + (len < DLL_INLINE_KEY_SIZE ? 0 : len + 1);
+    while (over_capacity(cache, entry->bytes) && cache->oldest != NULL)
+    {
+        dll_set_node *victim = eviction_victim(cache);
+        drop_entry(cache, victim);
+        cache->evictions++;
+    }
+    // CLOCK puts the new entry in the place of the victim, just behind the hand,
+    // so it is the last one the hand reaches.
+    link_before(cache, node, cache->policy == CACHE_CLOCK ? cache->hand : NULL);
+    cache->bytes += entry->bytes;
+    return entry->value;
+}
+
+/**
+ * Remove a key from the cache.
+ * Returns false if the key isn't cached.
+ */
+bool cache_remove(lru_cache *cache, char *key)
+{
+    if (cache == NULL || key == NULL)
+        return false;
+
+    dll_set_node *node = search_hash_table(cache->table, key);
+    if (node == NULL)
+        return false;
+    drop_entry(cache, node);
+    return true;
+}
+
+/**
+ * Get the count of cached entries.
+ */
+int cache_entry_count(lru_cache *cache)
+{
+    return cache != NULL ? cache->table->elementCount : 0;
+}
+
+/**
+ * Free the cache and every entry.
+ */
+void cleanup_lru_cache(lru_cache *cache)
+{
+    if (cache == NULL)
+        return;
+    cleanup_table(cache->table);
+    free(cache);
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#ifndef LRU_CACHE
+#define LRU_CACHE
+#include <stdbool.h>
+#include <stddef.h>
+#include "HashMap.h"
+
+/// @brief How a full cache picks the entry to evict.
+/// LRU moves every hit to the front of the recency list.
+/// CLOCK only marks hits and gives marked entries a second chance when evicting.
+typedef enum
+{
+    CACHE_LRU,
+    CACHE_CLOCK
+} cache_policy;
+
+/// @brief Recency links and value of a cache entry, stored on the payload of its node.
+typedef struct CacheEntry
+{
+    dll_set_node *newer;
+    dll_set_node *older;
+    size_t bytes;
+    bool referenced;
+    unsigned char value[];
+} cache_entry;
+
+/// @brief Bounded cache of value_size byte values over a hash_table.
+/// The recency list goes from newest to oldest. The clock hand walks it from older to newer
+/// entries and wraps, a NULL hand starts on the oldest. CLOCK links new entries just behind the hand.
+/// An entry costs its node plus the key bytes that don't fit inline.
+/// A limit of 0 means no limit. The cache isn't thread safe.
+typedef struct LRUCache
+{
+    hash_table *table;
+    cache_policy policy;
+    size_t value_size;
+    size_t max_entries;
+    size_t max_bytes;
+    size_t bytes;
+    dll_set_node *newest;
+    dll_set_node *oldest;
+    dll_set_node *hand;
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long evictions;
+} lru_cache;
+
+lru_cache *create_lru_cache(size_t max_entries, size_t max_bytes, size_t value_size, cache_policy policy);
+void *cache_get(lru_cache *cache, char *key);
+void *cache_put(lru_cache *cache, char *key, const void *value);
+bool cache_remove(lru_cache *cache, char *key);
+int cache_entry_count(lru_cache *cache);
+void cleanup_lru_cache(lru_cache *cache);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "NodePool.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define POOL_FIRST_NODES 64
+#define POOL_MAX_NODES 4096
+#define POOL_FIRST_KEY_BYTES 1024
+#define POOL_MAX_KEY_BYTES 65536
+
+/// @brief Alignment of the node slabs, the header of a node block is padded to it.
+#define POOL_NODE_ALIGN 64
+
+/**
+ * Get the data that follows a block header of header bytes.
+ */
+static void *block_data(pool_block *block, size_t header)
+{
+    return (void *)((char *)block + header);
+}
+
+/**
+ * Allocate a new block on a POOL_NODE_ALIGN boundary and push it in front of the list.
+ * The data starts header bytes after the block.
+ */
+static pool_block *push_block(node_pool *pool, pool_block **blocks, size_t capacity, size_t header, size_t bytes)
+{
+    void *memory = NULL;
+    if (posix_memalign(&memory, POOL_NODE_ALIGN, header + bytes) != 0)
+        return NULL;
+    pool_block *block = memory;
+    pool->allocated_bytes += header + bytes;
+    block->capacity = capacity;
+    block->next = *blocks;
+    *blocks = block;
+    return block;
+}
+
+/**
+ * Free every block of a list.
+ */
+static void free_blocks(pool_block *block)
+{
+    pool_block *temp = NULL;
+    while (block != NULL)
+    {
+        temp = block;
+        block = block->next;
+        free(temp);
+    }
+}
+
+/**
+ * Initialize a empty pool, no memory is allocated until the first node.
+ * Each node has payload_size extra bytes, the size is kept a multiple of 8.
+ * Slabs start on a 64 byte line, so nodes without payload each fill exactly one line.
+ */
+void init_node_pool(node_pool *pool, size_t payload_size)
+{
+    pool->node_size = (sizeof(dll_set_node) + payload_size + 7) & ~(size_t)7;
+    pool->node_blocks = NULL;
+    pool->node_used = 0;
+    pool->free_nodes = NULL;
+    pool->key_blocks = NULL;
+    pool->key_used = 0;
+    pool->allocated_bytes = 0;
+}
+
+/**
+ * Get a node from the pool.
+ * Reuses freed nodes first, else takes the next one of the current slab.
+ */
+dll_set_node *alloc_pool_node(node_pool *pool)
+{
+    if (pool->free_nodes != NULL)
+    {
+        dll_set_node *node = pool->free_nodes;
+        pool->free_nodes = node->next;
+        return node;
+    }
+
+    // The current slab is full, allocate one twice as big.
+    pool_block *block = pool->node_blocks;
+    if (block == NULL || pool->node_used == block->capacity)
+    {
+        size_t capacity = block == NULL ? POOL_FIRST_NODES : block->capacity * 2;
+        if (capacity > POOL_MAX_NODES)
+            capacity = POOL_MAX_NODES;
+        block = push_block(pool, &pool->node_blocks, capacity, POOL_NODE_ALIGN, capacity * pool->node_size);
+        if (block == NULL)
+            return NULL;
+        pool->node_used = 0;
+    }
+    return (dll_set_node *)((char *)block_data(block, POOL_NODE_ALIGN) + pool->node_size * pool->node_used++);
+}
+
+/**
+ * Give a node back to the pool.
+ * The key bytes stay on the arena until the pool is cleaned up.
+ */
+void free_pool_node(node_pool *pool, dll_set_node *node)
+{
+    node->next = pool->free_nodes;
+    pool->free_nodes = node;
+}
+
+/**
+ * Copy the key to the arena.
+ * Keys that don't fit the current block get a new one.
+ */
+char *pool_strdup(node_pool *pool, const char *key)
+{
+    size_t len = strlen(key) + 1;
+    pool_block *block = pool->key_blocks;
+    if (block == NULL || block->capacity - pool->key_used < len)
+    {
+        size_t capacity = block == NULL ? POOL_FIRST_KEY_BYTES : block->capacity * 2;
+        if (capacity > POOL_MAX_KEY_BYTES)
+            capacity = POOL_MAX_KEY_BYTES;
+        if (capacity < len)
+            capacity = len;
+        block = push_block(pool, &pool->key_blocks, capacity, sizeof(pool_block), capacity);
+        if (block == NULL)
+            return NULL;
+        pool->key_used = 0;
+    }
+    char *copy = (char *)block_data(block, sizeof(pool_block)) + pool->key_used;
+    memcpy(copy, key, len);
+    pool->key_used += len;
+    return copy;
+}
+
+/**
+ * Release every node and key of the pool at once.
+ */
+void cleanup_node_pool(node_pool *pool)
+{
+    free_blocks(pool->node_blocks);
+    free_blocks(pool->key_blocks);
+    init_node_pool(pool, pool->node_size - sizeof(dll_set_node));
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#ifndef NODE_POOL
+#define NODE_POOL
+#include <stddef.h>
+#include "DoublyLinkedList.h"
+
+/// @brief Header of a block owned by the pool, the data follows it.
+typedef struct PoolBlock
+{
+    struct PoolBlock *next;
+    size_t capacity;
+} pool_block;
+
+/// @brief Slab of list nodes plus a bump arena for the key bytes.
+/// Nodes are node_size bytes, room for a payload after the dll_set_node.
+/// Node slabs are 64 byte aligned, a payload makes a node span more than one line.
+/// Everything is released at once by cleanup_node_pool.
+typedef struct NodePool
+{
+    size_t node_size;
+    pool_block *node_blocks;
+    size_t node_used;
+    dll_set_node *free_nodes;
+    pool_block *key_blocks;
+    size_t key_used;
+    size_t allocated_bytes;
+} node_pool;
+
+void init_node_pool(node_pool *pool, size_t payload_size);
+dll_set_node *alloc_pool_node(node_pool *pool);
+void free_pool_node(node_pool *pool, dll_set_node *node);
+char *pool_strdup(node_pool *pool, const char *key);
+void cleanup_node_pool(node_pool *pool);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,206 @@
+#include "ShardedHashMap.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Get the partition of a hash.
+ * The high bits are used, the low ones already pick the bucket inside each map.
+ */
+static int partition_of(sharded_hash_table *table, uint64_t hash)
+{
+    return (int)((hash >> 32) & (uint64_t)(table->partitions - 1));
+}
+
+/**
+ * Create a table for the given workers.
+ * partitions is rounded up to a power of two, it bounds the threads a merge can use.
+ * Returns NULL if a map couldn't be allocated.
+ */
+sharded_hash_table *create_sharded_hash_table(int workers, int partitions)
+{
+    if (workers < 1 || partitions < 1)
+        return NULL;
+
+    sharded_hash_table *table = malloc(sizeof(sharded_hash_table));
+    if (table == NULL)
+        return NULL;
+    table->workers = workers;
+    table->partitions = 1;
+    while (table->partitions < partitions)
+        table->partitions *= 2;
+
+    // Every map uses the default hash, so a cached hash is valid on all of them.
+    int count = workers * table->partitions;
+    table->locals = calloc(count, sizeof(hash_table *));
+    table->merged = calloc(table->partitions, sizeof(hash_table *));
+    bool created = table->locals != NULL && table->merged != NULL;
+    for (int i = 0; created && i < count; i++)
+        created = (table->locals[i] = create_hash_table()) != NULL;
+    for (int i = 0; created && i < table->partitions; i++)
+        created = (table->merged[i] = create_hash_table()) != NULL;
+    if (!created)
+    {
+        cleanup_sharded_hash_table(table);
+        return NULL;
+    }
+    return table;
+}
+
+/**
+ * Add delta to the count of a key on the private maps of a worker, a new key starts at 0.
+ * Only the thread of the worker may call this with its index.
+ * Returns false if the key couldn't be inserted.
+ */
+bool sharded_add(sharded_hash_table *table, int worker, char *key, int delta)
+{
+    if (table == NULL || key == NULL || worker < 0 || worker >= table->workers)
+        return false;
+
+    uint64_t hash = hash_bytes_words(key, strlen(key));
+    hash_table *local = table->locals[worker * table->partitions + partition_of(table, hash)];
+    bool inserted = false;
+    dll_set_node *node = get_or_insert_hashed(local, key, hash, delta, &inserted);
+    if (node == NULL)
+        return false;
+    if (!inserted)
+        node->val += delta;
+    return true;
+}
+
+/// @brief Partitions merged by one thread and the outcome.
+typedef struct MergeWorker
+{
+    sharded_hash_table *table;
+    int first;
+    int step;
+    bool merged;
+} merge_worker;
+
+/**
+ * Fold the maps of every worker for the partitions of a merge thread, then clear them.
+ * The cached hash of each node is reused, so no key is hashed again.
+ */
+static void *merge_partitions(void *arg)
+{
+    merge_worker *worker = arg;
+    sharded_hash_table *table = worker->table;
+    worker->merged = true;
+    for (int p = worker->first; p < table->partitions; p += worker->step)
+    {
+        for (int w = 0; w < table->workers; w++)
+        {
+            hash_table *local = table->locals[w * table->partitions + p];
+            hash_table_cursor cursor;
+            hash_table_cursor_begin(local, &cursor);
+            dll_set_node *node = NULL;
+            while ((node = hash_table_cursor_next(&cursor)) != NULL)
+            {
+                bool inserted = false;
+                dll_set_node *total = get_or_insert_hashed(table->merged[p], node->key, node->hash, node->val, &inserted);
+                if (total == NULL)
+                    worker->merged = false;
+                else if (!inserted)
+                    total->val += node->val;
+            }
+            hash_table_cursor_close(&cursor);
+            clear_hash_table(local);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Merge the private maps of every worker into the merged maps, using up to threads threads.
+ * The private maps are cleared, so merging again at a later checkpoint only adds the new counts.
+ * A thread that can't be started has its partitions merged by the calling thread.
+ * Returns false if a allocation failed, the totals of some keys are then missing.
+ */
+bool merge_sharded_hash_table(sharded_hash_table *table, int threads)
+{
+    if (table == NULL)
+        return false;
+    if (threads < 1)
+        threads = 1;
+    if (threads > table->partitions)
+        threads = table->partitions;
+
+    merge_worker *workers = malloc(threads * sizeof(merge_worker));
+    pthread_t *ids = malloc(threads * sizeof(pthread_t));
+    bool *started = malloc(threads * sizeof(bool));
+    if (workers == NULL || ids == NULL || started == NULL)
+    {
+        free(workers);
+        free(ids);
+        free(started);
+        return false;
+    }
+
+    for (int i = 0; i < threads; i++)
+    {
+        workers[i].table = table;
+        workers[i].first = i;
+        workers[i].step = threads;
+    }
+
+    // The first thread's share runs on the calling thread.
+    for (int i = 1; i < threads; i++)
+        started[i] = pthread_create(&ids[i], NULL, merge_partitions, &workers[i]) == 0;
+    merge_partitions(&workers[0]);
+    bool merged = workers[0].merged;
+    for (int i = 1; i < threads; i++)
+    {
+        if (started[i])
+            pthread_join(ids[i], NULL);
+        else
+            merge_partitions(&workers[i]);
+        merged = merged && workers[i].merged;
+    }
+
+    free(workers);
+    free(ids);
+    free(started);
+    return merged;
+}
+
+/**
+ * Search for a key on the merged maps.
+ * Counts added since the last merge aren't seen.
+ * Might return NULL if not found.
+ */
+dll_set_node *search_sharded_hash_table(sharded_hash_table *table, char *key)
+{
+    if (table == NULL || key == NULL)
+        return NULL;
+    uint64_t hash = hash_bytes_words(key, strlen(key));
+    return search_hash_table(table->merged[partition_of(table, hash)], key);
+}
+
+/**
+ * Get the count of keys on the merged maps.
+ */
+int sharded_element_count(sharded_hash_table *table)
+{
+    if (table == NULL)
+        return 0;
+    int count = 0;
+    for (int p = 0; p < table->partitions; p++)
+        count += table->merged[p]->elementCount;
+    return count;
+}
+
+/**
+ * Free every map and the table itself.
+ */
+void cleanup_sharded_hash_table(sharded_hash_table *table)
+{
+    if (table == NULL)
+        return;
+    for (int i = 0; table->locals != NULL && i < table->workers * table->partitions; i++)
+        cleanup_table(table->locals[i]);
+    for (int i = 0; table->merged != NULL && i < table->partitions; i++)
+        cleanup_table(table->merged[i]);
+    free(table->locals);
+    free(table->merged);
+    free(table);
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#ifndef SHARDED_HASH_MAP
+#define SHARDED_HASH_MAP
+#include <stdbool.h>
+#include "HashMap.h"
+
+/// @brief Aggregation table where each worker thread adds into its own private maps.
+/// Every worker has one map per partition, a key goes to partition (hash >> 32) % partitions.
+/// A merge combines the maps of each partition into merged[p], one partition per thread,
+/// so no two threads ever write the same map and no lock is taken.
+/// Adds and merges must not overlap, merge at the end of a phase or at a checkpoint.
+typedef struct ShardedHashTable
+{
+    int workers;
+    int partitions;
+    hash_table **locals;
+    hash_table **merged;
+} sharded_hash_table;
+
+sharded_hash_table *create_sharded_hash_table(int workers, int partitions);
+bool sharded_add(sharded_hash_table *table, int worker, char *key, int delta);
+bool merge_sharded_hash_table(sharded_hash_table *table, int threads);
+dll_set_node *search_sharded_hash_table(sharded_hash_table *table, char *key);
+int sharded_element_count(sharded_hash_table *table);
+void cleanup_sharded_hash_table(sharded_hash_table *table);
+
+#endif
\ No newline at end of file
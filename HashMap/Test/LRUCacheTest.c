@@ -0,0 +1,113 @@
+/**
+ * Checks of the eviction order of the LRU and CLOCK caches.
+ * CLOCK must resume every sweep where the last one stopped, so an entry read after
+ * its mark was cleared survives the next evictions. Exits with 1 on the first failure.
+ *
+ * Build from the HashMap directory with make lru_cache_test.
+ */
+#include "../LRUCache.h"
+#include <stdio.h>
+#include <string.h>
+
+static int failures = 0;
+
+/**
+ * Report a failed check.
+ */
+static void check(bool ok, const char *what)
+{
+    if (ok)
+        return;
+    printf("FAIL: %s\n", what);
+    failures++;
+}
+
+/**
+ * Check if a key is cached without marking it as used.
+ */
+static bool cached(lru_cache *cache, char *key)
+{
+    return search_hash_table(cache->table, key) != NULL;
+}
+
+/**
+ * Check the key the clock hand points to, NULL for a hand on the oldest entry.
+ */
+static bool hand_on(lru_cache *cache, char *key)
+{
+    if (key == NULL)
+        return cache->hand == NULL;
+    return cache->hand != NULL && strcmp(cache->hand->key, key) == 0;
+}
+
+/**
+ * Put a key with its first byte as value.
+ */
+static void put(lru_cache *cache, char *key)
+{
+    check(cache_put(cache, key, key) != NULL, "put");
+}
+
+static void test_lru()
+{
+    lru_cache *cache = create_lru_cache(3, 0, 1, CACHE_LRU);
+    put(cache, "A");
+    put(cache, "B");
+    put(cache, "C");
+    cache_get(cache, "A");
+    put(cache, "D");
+    check(!cached(cache, "B") && cached(cache, "A"), "lru evicts the least recently used");
+    put(cache, "E");
+    check(!cached(cache, "C") && cached(cache, "A"), "lru keeps the recently read entry");
+    check(cache->evictions == 2, "lru eviction count");
+    cleanup_lru_cache(cache);
+}
+
+static void test_clock()
+{
+    lru_cache *cache = create_lru_cache(3, 0, 1, CACHE_CLOCK);
+    put(cache, "A");
+    put(cache, "B");
+    put(cache, "C");
+    check(hand_on(cache, NULL), "hand starts on the oldest");
+
+    // A gets a second chance, B goes and the hand stops after it.
+    cache_get(cache, "A");
+    put(cache, "D");
+    check(!cached(cache, "B") && cached(cache, "A"), "clock skips the marked entry");
+    check(hand_on(cache, "C"), "hand after the first victim");
+
+    // The sweep resumes on C, A keeps its place even with its mark cleared.
+    put(cache, "E");
+    check(!cached(cache, "C") && cached(cache, "A"), "clock resumes at the hand");
+    check(hand_on(cache, "A"), "hand wraps to the oldest");
+
+    // A is reached again with no mark, D and E were linked behind the hand.
+    put(cache, "F");
+    check(!cached(cache, "A") && cached(cache, "D") && cached(cache, "E"), "clock evicts the unmarked entry");
+    check(hand_on(cache, "D"), "hand after the third victim");
+
+    // Every entry marked, a full sweep clears them and evicts the hand entry.
+    cache_get(cache, "D");
+    cache_get(cache, "E");
+    cache_get(cache, "F");
+    put(cache, "G");
+    check(!cached(cache, "D") && cached(cache, "E") && cached(cache, "F"), "clock full sweep");
+    check(hand_on(cache, "E"), "hand after the full sweep");
+
+    // Removing the hand entry moves the hand to the next one.
+    cache_remove(cache, "E");
+    check(hand_on(cache, "F"), "hand moves off a removed entry");
+    check(cache->evictions == 4, "clock eviction count");
+    cleanup_lru_cache(cache);
+}
+
+int main()
+{
+    test_lru();
+    test_clock();
+    if (failures != 0)
+        return 1;
+    printf("ok\n");
+    return 0;
+}
\ No newline at end of file
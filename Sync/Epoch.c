@@ -0,0 +1,79 @@
+#include "Epoch.h"
+#include <sched.h>
+
+static _Atomic int next_thread_slot = 0;
+static _Thread_local int thread_slot = -1;
+
+/**
+ * Get the slot of the calling thread, assigned on the first call.
+ */
+static int get_thread_slot()
+{
+    if (thread_slot < 0)
+        thread_slot = atomic_fetch_add(&next_thread_slot, 1) % EPOCH_SLOTS;
+    return thread_slot;
+}
+
+/**
+ * Initialize a domain with every counter at zero.
+ */
+bool init_epoch_domain(epoch_domain *domain)
+{
+    for (int i = 0; i < EPOCH_SLOTS; i++)
+    {
+        atomic_init(&domain->slots[i].active[0], 0);
+        atomic_init(&domain->slots[i].active[1], 0);
+    }
+    atomic_init(&domain->epoch, 0);
+    return pthread_mutex_init(&domain->sync_lock, NULL) == 0;
+}
+
+/**
+ * Start a read section.
+ * Returns the token that must be passed to epoch_exit.
+ */
+int epoch_enter(epoch_domain *domain)
+{
+    int slot = get_thread_slot();
+    int parity = (int)(atomic_load(&domain->epoch) & 1);
+    atomic_fetch_add(&domain->slots[slot].active[parity], 1);
+    return slot * 2 + parity;
+}
+
+/**
+ * End a read section started by epoch_enter.
+ */
+void epoch_exit(epoch_domain *domain, int token)
+{
+    atomic_fetch_sub_explicit(&domain->slots[token / 2].active[token % 2], 1, memory_order_release);
+}
+
+/**
+ * Wait every read section started before the call.
+ * Memory unlinked before the call can be freed once it returns.
+ */
+void epoch_synchronize(epoch_domain *domain)
+{
+    pthread_mutex_lock(&domain->sync_lock);
+
+    // Flip twice so both parities are drained, no matter which one a slow reader read.
+    for (int flip = 0; flip < 2; flip++)
+    {
+        int parity = (int)(atomic_fetch_add(&domain->epoch, 1) & 1);
+        for (int i = 0; i < EPOCH_SLOTS; i++)
+        {
+            while (atomic_load(&domain->slots[i].active[parity]) != 0)
+                sched_yield();
+        }
+    }
+
+    pthread_mutex_unlock(&domain->sync_lock);
+}
+
+/**
+ * Release the resources of a domain, no reader may be active.
+ */
+void cleanup_epoch_domain(epoch_domain *domain)
+{
+    pthread_mutex_destroy(&domain->sync_lock);
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef EPOCH_H
+#define EPOCH_H
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+/// @brief Number of reader counters, threads are spread over them by id.
+#define EPOCH_SLOTS 64
+
+/// @brief Reader counters for both epoch parities, one cache line per slot.
+typedef struct EpochSlot
+{
+    _Atomic long active[2];
+    char padding[64 - 2 * sizeof(long)];
+} epoch_slot;
+
+/// @brief Lets readers run without locks while writers wait for them before freeing memory.
+/// A reader counts itself on the parity of the current epoch, a writer flips the
+/// epoch twice and waits for each old parity to drain.
+typedef struct EpochDomain
+{
+    epoch_slot slots[EPOCH_SLOTS];
+    _Atomic unsigned long epoch;
+    pthread_mutex_t sync_lock;
+} epoch_domain;
+
+bool init_epoch_domain(epoch_domain *domain);
+int epoch_enter(epoch_domain *domain);
+void epoch_exit(epoch_domain *domain, int token);
+void epoch_synchronize(epoch_domain *domain);
+void cleanup_epoch_domain(epoch_domain *domain);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,105 @@
+#ifndef AVL_RETRACE_H
+#define AVL_RETRACE_H
+
+/// @brief Generate the rotations and the retracing of a iterative AVL over any
+/// node storage, so the pointer tree and the index pool share one copy.
+/// A link is a place that holds a node: the root or a child slot of a parent.
+/// Before DEFINE_AVL_RETRACE(avl, ctx_type, node_type, link_type) the file
+/// defines the accessors, taking the ctx first:
+///   node_type avlLinkNode(ctx, link_type link)
+///   void avlSetLink(ctx, link_type link, node_type node)
+///   link_type avlLeftLink(ctx, node_type node), avlRightLink(ctx, node)
+///   int avlNodeHeight(ctx, node_type node), 0 for the empty node
+///   void avlUpdateNode(ctx, node_type node), recomputes the height
+/// and gets avlBalance, avlRotateLeft, avlRotateRight, avlRebalance,
+/// avlRetraceInsert and avlRetraceRemove.
+#define DEFINE_AVL_RETRACE(prefix, ctx_type, node_type, link_type)             \
+                                                                               \
+  static inline int prefix##Balance(ctx_type ctx, node_type node) {            \
+    node_type left = prefix##LinkNode(ctx, prefix##LeftLink(ctx, node));       \
+    node_type right = prefix##LinkNode(ctx, prefix##RightLink(ctx, node));     \
+    return prefix##NodeHeight(ctx, left) - prefix##NodeHeight(ctx, right);     \
+  }                                                                            \
+                                                                               \
+  /* Rotate the subtree on link to the left, the right child goes up. */       \
+  static inline void prefix##RotateLeft(ctx_type ctx, link_type link) {        \
+    node_type node = prefix##LinkNode(ctx, link);                              \
+    node_type r = prefix##LinkNode(ctx, prefix##RightLink(ctx, node));         \
+    prefix##SetLink(ctx, prefix##RightLink(ctx, node),                         \
+                    prefix##LinkNode(ctx, prefix##LeftLink(ctx, r)));          \
+    prefix##SetLink(ctx, prefix##LeftLink(ctx, r), node);                      \
+    prefix##UpdateNode(ctx, node);                                             \
+    prefix##UpdateNode(ctx, r);                                                \
+    prefix##SetLink(ctx, link, r);                                             \
+  }                                                                            \
+                                                                               \
+  /* Rotate the subtree on link to the right, the left child goes up. */       \
+  static inline void prefix##RotateRight(ctx_type ctx, link_type link) {       \
+    node_type node = prefix##LinkNode(ctx, link);                              \
+    node_type l = prefix##LinkNode(ctx, prefix##LeftLink(ctx, node));          \
+    prefix##SetLink(ctx, prefix##LeftLink(ctx, node),                          \
+                    prefix##LinkNode(ctx, prefix##RightLink(ctx, l)));         \
+    prefix##SetLink(ctx, prefix##RightLink(ctx, l), node);                     \
+    prefix##UpdateNode(ctx, node);                                             \
+    prefix##UpdateNode(ctx, l);                                                \
+    prefix##SetLink(ctx, link, l);                                             \
+  }                                                                            \
+                                                                               \
+  /* Restore a subtree whose children differ in height by two, the case is     \
+     picked from the balance of the deeper child, no value is read. */         \
+  static inline void prefix##Rebalance(ctx_type ctx, link_type link) {         \
+    node_type node = prefix##LinkNode(ctx, link);                              \
+    if (prefix##Balance(ctx, node) > 1) {                                      \
+      link_type left = prefix##LeftLink(ctx, node);                            \
+      if (prefix##Balance(ctx, prefix##LinkNode(ctx, left)) < 0)               \
+        prefix##RotateLeft(ctx, left);                                         \
+      prefix##RotateRight(ctx, link);                                          \
+    } else {                                                                   \
+      link_type right = prefix##RightLink(ctx, node);                          \
+      if (prefix##Balance(ctx, prefix##LinkNode(ctx, right)) > 0)              \
+        prefix##RotateRight(ctx, right);                                       \
+      prefix##RotateLeft(ctx, link);                                           \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  /* Retrace the links above a new leaf. A rotation after a insert gives the   \
+     subtree back its old height, so it stops there or at the first height     \
+     that didn't change. Returns the count of links left above. */             \
+  static inline int prefix##RetraceInsert(ctx_type ctx, link_type path[],      \
+                                          int depth) {                         \
+    while (depth > 0) {                                                        \
+      link_type link = path[--depth];                                          \
+      node_type node = prefix##LinkNode(ctx, link);                            \
+      int oldHeight = prefix##NodeHeight(ctx, node);                           \
+      prefix##UpdateNode(ctx, node);                                           \
+      int balance = prefix##Balance(ctx, node);                                \
+      if (balance > 1 || balance < -1) {                                       \
+        prefix##Rebalance(ctx, link);                                          \
+        break;                                                                 \
+      }                                                                        \
+      if (prefix##NodeHeight(ctx, node) == oldHeight)                          \
+        break;                                                                 \
+    }                                                                          \
+    return depth;                                                              \
+  }                                                                            \
+                                                                               \
+  /* Retrace the links above a unlinked node. Removing can shorten a subtree   \
+     even after a rotation, so it only stops at the first height that stays    \
+     the same. Returns the count of links left above. */                       \
+  static inline int prefix##RetraceRemove(ctx_type ctx, link_type path[],      \
+                                          int depth) {                         \
+    while (depth > 0) {                                                        \
+      link_type link = path[--depth];                                          \
+      node_type node = prefix##LinkNode(ctx, link);                            \
+      int oldHeight = prefix##NodeHeight(ctx, node);                           \
+      prefix##UpdateNode(ctx, node);                                           \
+      int balance = prefix##Balance(ctx, node);                                \
+      if (balance > 1 || balance < -1)                                         \
+        prefix##Rebalance(ctx, link);                                          \
+      if (prefix##NodeHeight(ctx, prefix##LinkNode(ctx, link)) == oldHeight)   \
+        break;                                                                 \
+    }                                                                          \
+    return depth;                                                              \
+  }
+
+#endif
@@ -1,4 +1,6 @@
 #include "AVLTree.h"
+#include "AVLRetrace.h"
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #define getMax(x, y) ((x) > (y) ? (x) : (y))
@@ -15,6 +17,9 @@ avl_node *createNode(int val) {
     return NULL;
 
   new->height = 1;
+#ifdef AVL_ORDER_STATISTICS
+  new->size = 1;
+#endif
   new->val = val;
   new->left = NULL;
   new->right = NULL;
@@ -32,71 +37,264 @@ avl_node *findMinBst(avl_node *root) {
 }
 
 /**
- * Insert a new node in the right position of the BST.
- * Handle duplicates, inicialization and rotation.
- * @param **root A pointer to the address of the root.
- * @param val The value to be inserted.
- * @return True if sucess, else False.
+ * Recompute the height of a node from its children, and its size if counted.
+ * @param *node The node to update.
  */
-bool insertAVLNode(avl_node **root, int val) {
-  // Verifies if  the root is not NULL, if it is, initialize it.
-  if (*root == NULL) {
-    avl_node *toInsert = createNode(val);
-    if (toInsert == NULL)
-      return false;
-    *root = toInsert;
-    return true;
-  }
+static void updateHeight(avl_node *node) {
+  node->height = 1 + getMax(getHeight(node->left), getHeight(node->right));
+#ifdef AVL_ORDER_STATISTICS
+  node->size = 1 + getSize(node->left) + getSize(node->right);
+#endif
+}
 
-  // Handle the recursive insertion.
-  if ((*root)->val > val) {
-    // Handle cases where didn't inserted.
-    if (!insertAVLNode(&((*root)->left), val)) {
-      return false;
+/**
+ * Add delta to the size of the nodes of a path that retracing didn't reach.
+ * The heights up there didn't change, but each subtree gained or lost one node.
+ * @param ***path The links from the root down.
+ * @param depth The number of links not retraced.
+ * @param delta 1 after a insert, -1 after a remove.
+ */
+static void adjustPathSizes(avl_node **path[], int depth, int delta) {
+#ifdef AVL_ORDER_STATISTICS
+  while (depth > 0)
+    (*path[--depth])->size += delta;
+#else
+  (void)path;
+  (void)depth;
+  (void)delta;
+#endif
+}
+
+// Accessors of the shared retracing, a link is the address of a child pointer.
+static avl_node *avlLinkNode(void *ctx, avl_node **link) {
+  (void)ctx;
+  return *link;
+}
+
+static void avlSetLink(void *ctx, avl_node **link, avl_node *node) {
+  (void)ctx;
+  *link = node;
+}
+
+static avl_node **avlLeftLink(void *ctx, avl_node *node) {
+  (void)ctx;
+  return &node->left;
+}
+
+static avl_node **avlRightLink(void *ctx, avl_node *node) {
+  (void)ctx;
+  return &node->right;
+}
+
+static int avlNodeHeight(void *ctx, avl_node *node) {
+  (void)ctx;
+  return getHeight(node);
+}
+
+static void avlUpdateNode(void *ctx, avl_node *node) {
+  (void)ctx;
+  updateHeight(node);
+}
+
+DEFINE_AVL_RETRACE(avl, void *, avl_node *, avl_node **)
+
+/**
+ * Search for a node in the passed tree.
+ * @param *root The tree where the search will take place.
+ * @param val The value to be searched in the tree.
+ * @return The desired Node, NULL if not found.
+ */
+avl_node *searchAVLNode(avl_node *root, int val) {
+  while (root != NULL && root->val != val)
+    root = root->val > val ? root->left : root->right;
+  return root;
+}
+
+/**
+ * Find the node of the smallest value not below val.
+ * @param *root The tree to be searched.
+ * @param val The bound.
+ * @return The node, NULL if every value is smaller than val.
+ */
+avl_node *lowerBoundAVL(avl_node *root, int val) {
+  avl_node *bound = NULL;
+  while (root != NULL) {
+    if (root->val >= val) {
+      bound = root;
+      root = root->left;
+    } else {
+      root = root->right;
     }
-  } else if ((*root)->val < val) {
-    if (!insertAVLNode(&((*root)->right), val)) {
-      return false;
+  }
+  return bound;
+}
+
+/**
+ * Find the node of the smallest value above val.
+ * @param *root The tree to be searched.
+ * @param val The bound.
+ * @return The node, NULL if no value is bigger than val.
+ */
+avl_node *upperBoundAVL(avl_node *root, int val) {
+  avl_node *bound = NULL;
+  while (root != NULL) {
+    if (root->val > val) {
+      bound = root;
+      root = root->left;
+    } else {
+      root = root->right;
     }
-  } else {
-    // Duplicate.
-    return false;
   }
+  return bound;
+}
 
-  // Get the new height for the element.
-  // Since we inserted recursively from the Root, will affect all nodes on the
-  // subtree.
-  (*root)->height =
-      1 + getMax(getHeight((*root)->left), getHeight((*root)->right));
+/**
+ * Push a node and its leftmost descendants on a cursor.
+ * @return The leftmost node, now on top.
+ */
+static avl_node *pushLeftSpine(avl_cursor *cursor, avl_node *node) {
+  cursor->stack[cursor->depth++] = node;
+  while (node->left != NULL) {
+    node = node->left;
+    cursor->stack[cursor->depth++] = node;
+  }
+  return node;
+}
 
-  // Get the balance of the current node.
-  int balance = getBalance(*root);
+/**
+ * Position a cursor on the smallest value of a tree.
+ * @param *cursor The cursor to position.
+ * @param *root The tree to walk.
+ * @return The first node, NULL if the tree is empty.
+ */
+avl_node *beginAVLCursor(avl_cursor *cursor, avl_node *root) {
+  cursor->depth = 0;
+  return root != NULL ? pushLeftSpine(cursor, root) : NULL;
+}
 
-  // Left subtree is deeper and the value was inserted to the left of the left
-  // subtree.
-  if (balance > 1 && (*root)->left->val > val) {
-    rotateRight(root);
+/**
+ * Position a cursor on the smallest value not below val, like lowerBoundAVL.
+ * @param *cursor The cursor to position.
+ * @param *root The tree to walk.
+ * @param val The bound.
+ * @return The node, NULL if every value is smaller than val.
+ */
+avl_node *seekAVLCursor(avl_cursor *cursor, avl_node *root, int val) {
+  // The path to the bound is a prefix of the walked path, cut the rest.
+  int boundDepth = 0;
+  cursor->depth = 0;
+  while (root != NULL) {
+    cursor->stack[cursor->depth++] = root;
+    if (root->val >= val) {
+      boundDepth = cursor->depth;
+      root = root->left;
+    } else {
+      root = root->right;
+    }
   }
-  // Right subtree is deeper and the value was inserted to the right of the
-  // right subtree.
-  else if (balance < -1 && (*root)->right->val < val) {
-    rotateLeft(root);
+  cursor->depth = boundDepth;
+  return boundDepth > 0 ? cursor->stack[boundDepth - 1] : NULL;
+}
+
+/**
+ * Move a cursor to the next value in order.
+ * @param *cursor The cursor to move.
+ * @return The next node, NULL past the biggest value.
+ */
+avl_node *nextAVLCursor(avl_cursor *cursor) {
+  if (cursor->depth == 0)
+    return NULL;
+  avl_node *node = cursor->stack[cursor->depth - 1];
+  if (node->right != NULL)
+    return pushLeftSpine(cursor, node->right);
+
+  // Climb until coming up from a left child.
+  avl_node *child = NULL;
+  do {
+    child = cursor->stack[--cursor->depth];
+  } while (cursor->depth > 0 && cursor->stack[cursor->depth - 1]->right == child);
+  return cursor->depth > 0 ? cursor->stack[cursor->depth - 1] : NULL;
+}
+
+/**
+ * Move a cursor to the previous value in order.
+ * @param *cursor The cursor to move.
+ * @return The previous node, NULL before the smallest value.
+ */
+avl_node *prevAVLCursor(avl_cursor *cursor) {
+  if (cursor->depth == 0)
+    return NULL;
+  avl_node *node = cursor->stack[cursor->depth - 1];
+  if (node->left != NULL) {
+    node = node->left;
+    cursor->stack[cursor->depth++] = node;
+    while (node->right != NULL) {
+      node = node->right;
+      cursor->stack[cursor->depth++] = node;
+    }
+    return node;
   }
-  // Left subtree is deeper and the value was inserted at the right of the left
-  // subtree.
-  else if (balance > 1 && (*root)->left->val < val) {
-    // Rotate the left subtree (Which could unbalance it until the next
-    // rotation)
-    rotateLeft(&((*root)->left));
-    // Rotate the root again, balancing everything.
-    rotateRight(root);
+
+  // Climb until coming up from a right child.
+  avl_node *child = NULL;
+  do {
+    child = cursor->stack[--cursor->depth];
+  } while (cursor->depth > 0 && cursor->stack[cursor->depth - 1]->left == child);
+  return cursor->depth > 0 ? cursor->stack[cursor->depth - 1] : NULL;
+}
+
+/**
+ * Copy the values from the cursor up to high into a buffer, one batch at a time.
+ * Seek the cursor to the low end of the range first and call again while the
+ * buffer comes back full, each call resumes after the last value copied.
+ * @param *cursor The cursor, left on the first value not copied.
+ * @param high The biggest value of the range.
+ * @param *out The buffer receiving the values in order.
+ * @param max The capacity of the buffer.
+ * @return The number of values copied.
+ */
+int scanAVLRange(avl_cursor *cursor, int high, int *out, int max) {
+  int count = 0;
+  avl_node *node = cursor->depth > 0 ? cursor->stack[cursor->depth - 1] : NULL;
+  while (node != NULL && count < max && node->val <= high) {
+    out[count++] = node->val;
+    node = nextAVLCursor(cursor);
   }
-  // Right subtree is deeper and the value was inserted to the left of the right
-  // subtree.
-  else if (balance < -1 && (*root)->right->val > val) {
-    rotateRight(&((*root)->right));
-    rotateLeft(root);
+  return count;
+}
+
+/**
+ * Insert a new node in the right position of the BST.
+ * Handle duplicates, inicialization and rotation.
+ * The links walked down are kept on a stack and retraced upwards, stopping at
+ * the first rotation or at the first node whose height didn't change.
+ * @param **root A pointer to the address of the root.
+ * @param val The value to be inserted.
+ * @return True if sucess, else False.
+ */
+bool insertAVLNode(avl_node **root, int val) {
+  avl_node **path[AVL_MAX_HEIGHT];
+  int depth = 0;
+
+  // Walk down to the empty link, recording every link on the way.
+  avl_node **link = root;
+  while (*link != NULL) {
+    path[depth++] = link;
+    if ((*link)->val > val)
+      link = &((*link)->left);
+    else if ((*link)->val < val)
+      link = &((*link)->right);
+    else
+      // Duplicate.
+      return false;
   }
+
+  *link = createNode(val);
+  if (*link == NULL)
+    return false;
+
+  depth = avlRetraceInsert(NULL, path, depth);
+  adjustPathSizes(path, depth, 1);
   // Inserted sucessfully.
   return true;
 }
@@ -105,82 +303,48 @@ bool insertAVLNode(avl_node **root, int val) {
  * Remove a node from the AVL based on it's value.
  * Handle the leaf, one child and two child cases.
  * Automatically rotates it to mantain balanced.
+ * A node with two children takes the value of its successor, which is unlinked
+ * on the same walk down. Retracing stops at the first unchanged height.
  * @param **root A pointer to the address of the root.
  * @param val The value of the node to be deleted.
  * @return True if removed, false otherwise.
  */
 bool removeAVLNode(avl_node **root, int val) {
-  // Can't remove NULL node.
-  if (*root == NULL)
-    return false;
+  avl_node **path[AVL_MAX_HEIGHT];
+  int depth = 0;
 
-  // Node to be removed is to the left.
-  if ((*root)->val > val) {
-    // Couldn't remove (Doesn't exist).
-    if (!removeAVLNode(&((*root)->left), val)) {
-      return false;
-    }
+  // Find the node, recording every link above it.
+  avl_node **link = root;
+  while (*link != NULL && (*link)->val != val) {
+    path[depth++] = link;
+    link = (*link)->val > val ? &((*link)->left) : &((*link)->right);
   }
-  // Node to be removed is to the right.
-  else if (((*root)->val < val)) {
-    if (!removeAVLNode(&((*root)->right), val)) {
-      return false;
+  // Couldn't remove (Doesn't exist).
+  if (*link == NULL)
+    return false;
+
+  avl_node *toRemove = *link;
+  if (toRemove->left != NULL && toRemove->right != NULL) {
+    // Keep walking to the smallest value on the right child.
+    path[depth++] = link;
+    link = &(toRemove->right);
+    while ((*link)->left != NULL) {
+      path[depth++] = link;
+      link = &((*link)->left);
     }
+    // Copy the value to the current and unlink the successor instead.
+    avl_node *successor = *link;
+    toRemove->val = successor->val;
+    *link = successor->right;
+    free(successor);
   } else {
-    // No child, just free and set the pointer to NULL.
-    if ((*root)->left == NULL && (*root)->right == NULL) {
-      free(*root);
-      *root = NULL;
-    } else if ((*root)->left == NULL) {
-      // Just right child, change the current to it and free the old.
-      avl_node *temp = *root;
-      *root = (*root)->right;
-      free(temp);
-    } else if ((*root)->right == NULL) {
-      avl_node *temp = *root;
-      *root = (*root)->left;
-      free(temp);
-    } else {
-      // Found the node to be removed, get the smallest value on the right
-      // child.
-      avl_node *temp = findMinBst((*root)->right);
-      // Copy the value to the current and remove the smallest from the right.
-      (*root)->val = temp->val;
-      removeAVLNode(&((*root)->right), temp->val);
-    }
+    // At most one child, it takes the place of the node.
+    *link = toRemove->left != NULL ? toRemove->left : toRemove->right;
+    free(toRemove);
   }
 
-  // If we just removed the node, just return true.
-  if (*root == NULL)
-    return true;
-
-  // Get the new height.
-  (*root)->height =
-      1 + getMax(getHeight((*root)->left), getHeight((*root)->right));
-
-  int balance = getBalance(*root);
-
-  // Left subtree is deeper and isn't unbalanced to the right.
-  if (balance > 1 && getBalance((*root)->left) >= 0) {
-    // Just rotates to the right to correct the unbalanced left subtree.
-    rotateRight(root);
-  }
-  // Right subtree is deeper and isn't unbalanced to the right.
-  else if (balance < -1 && getBalance((*root)->right) <= 0) {
-    rotateLeft(root);
-  }
-  // Left subtree is deeper and unbalanced to the right.
-  else if (balance > 1 && getBalance((*root)->left) < 0) {
-    // Rotate the left subtree to correct the right unbalance.
-    rotateLeft(&((*root)->left));
-    rotateRight(root);
-  }
-  // Right subtree is deeper and unbalanced to the left.
-  else if (balance < -1 && getBalance((*root)->right) > 0) {
-    // Rotate the right subtree to correct the left unbalance.
-    rotateRight(&((*root)->right));
-    rotateLeft(root);
-  }
+  depth = avlRetraceRemove(NULL, path, depth);
+  adjustPathSizes(path, depth, -1);
 
   // Sucessfully removed.
   return true;
@@ -208,38 +372,372 @@ int getHeight(avl_node *node) { return node ? node->height : 0; }
  * Realize a rotation of the tree to the left.
  * @param **root A pointer to the root of the tree/subtree to be rotated.
  */
-void rotateLeft(avl_node **root) {
-  // New root.
-  avl_node *r = (*root)->right;
-  avl_node *rl = r->left;
+void rotateLeft(avl_node **root) { avlRotateLeft(NULL, root); }
 
-  r->left = *root;
-  (*root)->right = rl;
+/**
+ * Realize a rotation of the tree to the right.
+ * @param **root A pointer to the root of the tree/subtree to be rotated.
+ */
+void rotateRight(avl_node **root) { avlRotateRight(NULL, root); }
 
-  // Update the height of the new right.
-  (*root)->height =
-      1 + getMax(getHeight((*root)->left), getHeight((*root)->right));
-  // Update the height of the new root.
-  r->height = 1 + getMax(getHeight(r->left), getHeight(r->right));
-  *root = r;
+/**
+ * Build the balanced tree of a sorted range, the middle value is the root.
+ * @return The root of the subtree, NULL if empty or on allocation failure.
+ */
+static avl_node *buildRange(const int *vals, int first, int end, bool *failed) {
+  if (first >= end || *failed)
+    return NULL;
+
+  int mid = first + (end - first) / 2;
+  avl_node *root = createNode(vals[mid]);
+  if (root == NULL) {
+    *failed = true;
+    return NULL;
+  }
+  root->left = buildRange(vals, first, mid, failed);
+  root->right = buildRange(vals, mid + 1, end, failed);
+  updateHeight(root);
+  return root;
 }
 
 /**
- * Realize a rotation of the tree to the right.
- * @param **root A pointer to the root of the tree/subtree to be rotated.
+ * Build a perfectly balanced tree from a sorted array in O(n).
+ * @param *vals The values, strictly increasing.
+ * @param count The number of values.
+ * @return The root of the tree, NULL if empty or if a node couldn't be allocated.
+ */
+avl_node *buildAVLFromSorted(const int *vals, int count) {
+  bool failed = false;
+  avl_node *root = buildRange(vals, 0, count, &failed);
+  if (failed)
+    cleanupAVL(&root);
+  return root;
+}
+
+/**
+ * Join a node and a shorter right tree into the right spine of a taller left tree.
+ * @return The root of the joined tree.
+ */
+static avl_node *joinRight(avl_node *left, avl_node *mid, avl_node *right) {
+  avl_node *c = left->right;
+  if (getHeight(c) > getHeight(right) + 1) {
+    // Keep walking down the right spine.
+    left->right = joinRight(c, mid, right);
+    updateHeight(left);
+    if (getHeight(left->right) > getHeight(left->left) + 1)
+      rotateLeft(&left);
+    return left;
+  }
+
+  mid->left = c;
+  mid->right = right;
+  updateHeight(mid);
+  if (getHeight(mid) <= getHeight(left->left) + 1) {
+    left->right = mid;
+    updateHeight(left);
+    return left;
+  }
+  // The new subtree is two levels too tall, a double rotation fixes it.
+  rotateRight(&mid);
+  left->right = mid;
+  rotateLeft(&left);
+  return left;
+}
+
+/**
+ * Join a node and a shorter left tree into the left spine of a taller right tree.
+ * @return The root of the joined tree.
  */
-void rotateRight(avl_node **root) {
-  avl_node *l = (*root)->left;
-  avl_node *lr = l->right;
+static avl_node *joinLeft(avl_node *left, avl_node *mid, avl_node *right) {
+  avl_node *c = right->left;
+  if (getHeight(c) > getHeight(left) + 1) {
+    right->left = joinLeft(left, mid, c);
+    updateHeight(right);
+    if (getHeight(right->left) > getHeight(right->right) + 1)
+      rotateRight(&right);
+    return right;
+  }
 
-  l->right = *root;
-  (*root)->left = lr;
+  mid->left = left;
+  mid->right = c;
+  updateHeight(mid);
+  if (getHeight(mid) <= getHeight(right->right) + 1) {
+    right->left = mid;
+    updateHeight(right);
+    return right;
+  }
+  rotateLeft(&mid);
+  right->left = mid;
+  rotateRight(&right);
+  return right;
+}
 
-  (*root)->height =
-      1 + getMax(getHeight((*root)->left), getHeight((*root)->right));
-  l->height = 1 + getMax(getHeight(l->left), getHeight(l->right));
-  *root = l;
+/**
+ * Join two trees around a node, every value on left is smaller than the
+ * node and every value on right is bigger. O(difference of the heights).
+ * @return The root of the joined tree.
+ */
+static avl_node *joinNode(avl_node *left, avl_node *mid, avl_node *right) {
+  if (getHeight(left) > getHeight(right) + 1)
+    return joinRight(left, mid, right);
+  if (getHeight(right) > getHeight(left) + 1)
+    return joinLeft(left, mid, right);
+  mid->left = left;
+  mid->right = right;
+  updateHeight(mid);
+  return mid;
+}
+
+/**
+ * Join two trees around a new value.
+ * Every value on left must be smaller than val and every value on right bigger.
+ * @param **root Receives the joined tree.
+ * @param *left The tree of the smaller values, consumed.
+ * @param val The value between both trees.
+ * @param *right The tree of the bigger values, consumed.
+ * @return True if joined, false if the node couldn't be allocated.
+ */
+bool joinAVL(avl_node **root, avl_node *left, int val, avl_node *right) {
+  avl_node *mid = createNode(val);
+  if (mid == NULL)
+    return false;
+  *root = joinNode(left, mid, right);
+  return true;
+}
+
+/**
+ * Detach the node with the biggest value of a tree.
+ * @param **last Receives the detached node.
+ * @return The root of the rest of the tree.
+ */
+static avl_node *splitLast(avl_node *root, avl_node **last) {
+  if (root->right == NULL) {
+    *last = root;
+    return root->left;
+  }
+  avl_node *rest = splitLast(root->right, last);
+  return joinNode(root->left, root, rest);
+}
+
+/**
+ * Concatenate two trees, every value on left must be smaller than every value on right.
+ * @param *left The tree of the smaller values, consumed.
+ * @param *right The tree of the bigger values, consumed.
+ * @return The root of the concatenated tree.
+ */
+avl_node *concatAVL(avl_node *left, avl_node *right) {
+  if (left == NULL)
+    return right;
+  avl_node *last = NULL;
+  left = splitLast(left, &last);
+  return joinNode(left, last, right);
+}
+
+/**
+ * Split a tree by a value, the node holding it is detached.
+ * @return The detached node, NULL if the value isn't on the tree.
+ */
+static avl_node *splitNode(avl_node *root, int val, avl_node **left, avl_node **right) {
+  if (root == NULL) {
+    *left = NULL;
+    *right = NULL;
+    return NULL;
+  }
+
+  avl_node *found = NULL;
+  if (root->val == val) {
+    *left = root->left;
+    *right = root->right;
+    return root;
+  }
+  if (root->val > val) {
+    found = splitNode(root->left, val, left, &(root->left));
+    *right = joinNode(root->left, root, root->right);
+  } else {
+    found = splitNode(root->right, val, &(root->right), right);
+    *left = joinNode(root->left, root, root->right);
+  }
+  return found;
+}
+
+/**
+ * Split a tree in the values smaller and bigger than val, in O(log n).
+ * @param *root The tree to be split, consumed.
+ * @param val The value to split by, its node is freed if found.
+ * @param **left Receives the tree of the smaller values.
+ * @param **right Receives the tree of the bigger values.
+ * @return True if val was on the tree.
+ */
+bool splitAVL(avl_node *root, int val, avl_node **left, avl_node **right) {
+  avl_node *found = splitNode(root, val, left, right);
+  free(found);
+  return found != NULL;
+}
+
+/// @brief Set operation run by setOperation.
+typedef enum { AVL_UNION, AVL_INTERSECT, AVL_DIFFERENCE } avl_set_op;
+
+/// @brief Arguments and result of a forked set operation.
+typedef struct AvlSetTask {
+  avl_set_op op;
+  avl_node *a;
+  avl_node *b;
+  int threads;
+  avl_node *result;
+} avl_set_task;
+
+static avl_node *setOperation(avl_set_op op, avl_node *a, avl_node *b, int threads);
+
+static void *runSetTask(void *arg) {
+  avl_set_task *task = arg;
+  task->result = setOperation(task->op, task->a, task->b, task->threads);
+  return NULL;
+}
+
+/**
+ * Split b by the root of a and combine the halves recursively, joining the results.
+ * Both trees are consumed. With a thread budget over one and big enough trees
+ * the left halves run on a new thread, which takes half of the budget.
+ * @return The root of the resulting tree.
+ */
+static avl_node *setOperation(avl_set_op op, avl_node *a, avl_node *b, int threads) {
+  if (a == NULL || b == NULL) {
+    if (op == AVL_UNION)
+      return a != NULL ? a : b;
+    if (op == AVL_INTERSECT || a == NULL) {
+      cleanupAVL(&a);
+      cleanupAVL(&b);
+      return NULL;
+    }
+    return a;
+  }
+
+  avl_node *bLeft = NULL;
+  avl_node *bRight = NULL;
+  avl_node *dup = splitNode(b, a->val, &bLeft, &bRight);
+  avl_node *aLeft = a->left;
+  avl_node *aRight = a->right;
+
+  avl_set_task task = {op, aLeft, bLeft, threads / 2, NULL};
+  pthread_t id;
+  bool forked = threads > 1 && getHeight(a) >= AVL_PARALLEL_HEIGHT &&
+                getHeight(bLeft) + getHeight(bRight) >= AVL_PARALLEL_HEIGHT &&
+                pthread_create(&id, NULL, runSetTask, &task) == 0;
+  avl_node *right = setOperation(op, aRight, bRight, threads - threads / 2);
+  if (forked)
+    pthread_join(id, NULL);
+  else
+    runSetTask(&task);
+  avl_node *left = task.result;
+
+  // The root of a stays if the operation keeps its value.
+  bool keep = op == AVL_UNION || (op == AVL_INTERSECT) == (dup != NULL);
+  free(dup);
+  if (keep)
+    return joinNode(left, a, right);
+  free(a);
+  return concatAVL(left, right);
+}
+
+/**
+ * Union of two trees in O(m log(n / m + 1)), m being the smaller size.
+ * @param *a The first tree, consumed.
+ * @param *b The second tree, consumed.
+ * @param threads The most threads to use, 1 runs on the calling thread only.
+ * @return The tree of the values on either tree.
+ */
+avl_node *unionAVL(avl_node *a, avl_node *b, int threads) {
+  return setOperation(AVL_UNION, a, b, threads);
+}
+
+/**
+ * Intersection of two trees in O(m log(n / m + 1)), m being the smaller size.
+ * @param *a The first tree, consumed.
+ * @param *b The second tree, consumed.
+ * @param threads The most threads to use, 1 runs on the calling thread only.
+ * @return The tree of the values on both trees.
+ */
+avl_node *intersectAVL(avl_node *a, avl_node *b, int threads) {
+  return setOperation(AVL_INTERSECT, a, b, threads);
+}
+
+/**
+ * Difference of two trees in O(m log(n / m + 1)), m being the smaller size.
+ * @param *a The tree to subtract from, consumed.
+ * @param *b The tree of the values to remove, consumed.
+ * @param threads The most threads to use, 1 runs on the calling thread only.
+ * @return The tree of the values of a that aren't on b.
+ */
+avl_node *differenceAVL(avl_node *a, avl_node *b, int threads) {
+  return setOperation(AVL_DIFFERENCE, a, b, threads);
+}
+
+#ifdef AVL_ORDER_STATISTICS
+/**
+ * Get the number of nodes of a subtree.
+ * @param *node The root of the subtree.
+ * @return The size of the subtree, 0 if NULL.
+ */
+int getSize(avl_node *node) { return node ? node->size : 0; }
+
+/**
+ * Count the values smaller than val, or smaller or equal if inclusive.
+ */
+static int countBelow(avl_node *root, int val, bool inclusive) {
+  int count = 0;
+  while (root != NULL) {
+    if (root->val < val || (inclusive && root->val == val)) {
+      count += getSize(root->left) + 1;
+      root = root->right;
+    } else {
+      root = root->left;
+    }
+  }
+  return count;
+}
+
+/**
+ * Get the rank of a value, the number of values smaller than it, in O(log n).
+ * @param *root The root of the tree.
+ * @param val The value to rank, it doesn't need to be on the tree.
+ * @return The rank of the value.
+ */
+int rankAVL(avl_node *root, int val) { return countBelow(root, val, false); }
+
+/**
+ * Find the k-th smallest value in O(log n).
+ * @param *root The root of the tree.
+ * @param k The position of the value, starting at 0.
+ * @return The node of the value, NULL if k is out of the tree.
+ */
+avl_node *selectAVL(avl_node *root, int k) {
+  while (root != NULL) {
+    int leftSize = getSize(root->left);
+    if (k == leftSize)
+      return root;
+    if (k < leftSize) {
+      root = root->left;
+    } else {
+      k -= leftSize + 1;
+      root = root->right;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Count the values in [low, high] in O(log n).
+ * @param *root The root of the tree.
+ * @param low The smallest value counted.
+ * @param high The biggest value counted.
+ * @return The number of values in the range, 0 if low > high.
+ */
+int countRangeAVL(avl_node *root, int low, int high) {
+  if (low > high)
+    return 0;
+  return countBelow(root, high, true) - countBelow(root, low, false);
 }
+#endif
 
 /**
  * Cleanup the Tree.
@@ -3,17 +3,40 @@
 
 #include <stdbool.h>
 
+/// @brief Deepest path insert and remove can record, far over the height of
+/// any AVL that fits in memory (about 1.44 * log2 of the node count).
+#define AVL_MAX_HEIGHT 64
+
+/// @brief Height both trees of a set operation need before the work is forked
+/// to a new thread, smaller trees merge faster than a thread starts.
+#define AVL_PARALLEL_HEIGHT 14
+
 /// @brief Simple AVL Node definition.
+/// Built with AVL_ORDER_STATISTICS every node also counts the nodes of its
+/// subtree, the flag must be the same for every file that includes this header.
 typedef struct node
 {
   int val;
   int height;
+#ifdef AVL_ORDER_STATISTICS
+  int size;
+#endif
   struct node *left;
   struct node *right;
 } avl_node;
 
+/// @brief In order position on a tree, the stack holds the path from the root
+/// down to the current node, which is on top. An empty stack is past the end.
+/// The tree must not change while a cursor is in use.
+typedef struct AvlCursor
+{
+  avl_node *stack[AVL_MAX_HEIGHT];
+  int depth;
+} avl_cursor;
+
 avl_node *createNode(int val);
 avl_node *findMinBst(avl_node *root);
+avl_node *searchAVLNode(avl_node *root, int val);
 
 bool insertAVLNode(avl_node **root, int val);
 bool removeAVLNode(avl_node **root, int val);
@@ -24,6 +47,31 @@ int getHeight(avl_node *node);
 void rotateLeft(avl_node **root);
 void rotateRight(avl_node **root);
 
+avl_node *lowerBoundAVL(avl_node *root, int val);
+avl_node *upperBoundAVL(avl_node *root, int val);
+
+avl_node *beginAVLCursor(avl_cursor *cursor, avl_node *root);
+avl_node *seekAVLCursor(avl_cursor *cursor, avl_node *root, int val);
+avl_node *nextAVLCursor(avl_cursor *cursor);
+avl_node *prevAVLCursor(avl_cursor *cursor);
+int scanAVLRange(avl_cursor *cursor, int high, int *out, int max);
+
+avl_node *buildAVLFromSorted(const int *vals, int count);
+bool joinAVL(avl_node **root, avl_node *left, int val, avl_node *right);
+avl_node *concatAVL(avl_node *left, avl_node *right);
+bool splitAVL(avl_node *root, int val, avl_node **left, avl_node **right);
+
+avl_node *unionAVL(avl_node *a, avl_node *b, int threads);
+avl_node *intersectAVL(avl_node *a, avl_node *b, int threads);
+avl_node *differenceAVL(avl_node *a, avl_node *b, int threads);
+
+#ifdef AVL_ORDER_STATISTICS
+int getSize(avl_node *node);
+int rankAVL(avl_node *root, int val);
+avl_node *selectAVL(avl_node *root, int k);
+int countRangeAVL(avl_node *root, int low, int high);
+#endif
+
 void cleanupAVL(avl_node **root);
 void printPreOrder(avl_node *root);
 
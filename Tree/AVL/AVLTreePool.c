@@ -0,0 +1,232 @@
+#include "AVLTreePool.h"
+#include "AVLRetrace.h"
+#include "AVLTree.h"
+#include <stdlib.h>
+#define getMax(x, y) ((x) > (y) ? (x) : (y))
+
+/**
+ * Initialize a empty pool with room for capacity nodes.
+ * @param *pool The pool to initialize.
+ * @param capacity The nodes to allocate up front, the pool grows past it.
+ * @return True if allocated, else False.
+ */
+bool initAVLPool(avl_pool *pool, uint32_t capacity) {
+  if (capacity < 1)
+    capacity = 1;
+  if (capacity > AVL_POOL_MAX_NODES)
+    capacity = AVL_POOL_MAX_NODES;
+
+  // One more slot for the reserved index 0.
+  pool->nodes = malloc((capacity + 1) * sizeof(avl_pool_node));
+  if (pool->nodes == NULL)
+    return false;
+  pool->capacity = capacity + 1;
+  resetAVLPool(pool);
+  return true;
+}
+
+/**
+ * Take a node from the free list or the end of the array, doubling it when full.
+ * @param *pool The pool to allocate from.
+ * @param val The value of the node.
+ * @return The index of the node, AVL_POOL_NULL if the pool can't grow.
+ */
+static uint32_t allocPoolNode(avl_pool *pool, int val) {
+  uint32_t index = pool->freeList;
+  if (index != AVL_POOL_NULL) {
+    pool->freeList = pool->nodes[index].left;
+  } else {
+    if (pool->used == pool->capacity) {
+      if (pool->capacity > AVL_POOL_MAX_NODES)
+        return AVL_POOL_NULL;
+      uint32_t capacity = pool->capacity * 2;
+      if (capacity > AVL_POOL_MAX_NODES + 1)
+        capacity = AVL_POOL_MAX_NODES + 1;
+      avl_pool_node *nodes = realloc(pool->nodes, capacity * sizeof(avl_pool_node));
+      if (nodes == NULL)
+        return AVL_POOL_NULL;
+      pool->nodes = nodes;
+      pool->capacity = capacity;
+    }
+    index = pool->used++;
+  }
+
+  avl_pool_node *node = &pool->nodes[index];
+  node->val = val;
+  node->left = AVL_POOL_NULL;
+  node->right = AVL_POOL_NULL;
+  node->height = 1;
+  return index;
+}
+
+/**
+ * Give a node back to the free list.
+ * @param *pool The pool of the node.
+ * @param index The node to free.
+ */
+static void freePoolNode(avl_pool *pool, uint32_t index) {
+  pool->nodes[index].left = pool->freeList;
+  pool->freeList = index;
+}
+
+/// @brief Slot holding a node: a child of parent, or the root when parent is
+/// AVL_POOL_NULL. Nodes move when the array grows, so links never hold addresses.
+typedef struct AvlPoolLink {
+  uint32_t parent;
+  bool right;
+} avl_pool_link;
+
+// Accessors of the shared retracing, the same code AVLTree.c runs on pointers.
+static uint32_t poolLinkNode(avl_pool *pool, avl_pool_link link) {
+  if (link.parent == AVL_POOL_NULL)
+    return pool->root;
+  return link.right ? pool->nodes[link.parent].right : pool->nodes[link.parent].left;
+}
+
+static void poolSetLink(avl_pool *pool, avl_pool_link link, uint32_t index) {
+  if (link.parent == AVL_POOL_NULL)
+    pool->root = index;
+  else if (link.right)
+    pool->nodes[link.parent].right = index;
+  else
+    pool->nodes[link.parent].left = index;
+}
+
+static avl_pool_link poolLeftLink(avl_pool *pool, uint32_t index) {
+  (void)pool;
+  return (avl_pool_link){index, false};
+}
+
+static avl_pool_link poolRightLink(avl_pool *pool, uint32_t index) {
+  (void)pool;
+  return (avl_pool_link){index, true};
+}
+
+static int poolNodeHeight(avl_pool *pool, uint32_t index) {
+  return index != AVL_POOL_NULL ? pool->nodes[index].height : 0;
+}
+
+static void poolUpdateNode(avl_pool *pool, uint32_t index) {
+  avl_pool_node *node = &pool->nodes[index];
+  node->height = 1 + getMax(poolNodeHeight(pool, node->left),
+                            poolNodeHeight(pool, node->right));
+}
+
+DEFINE_AVL_RETRACE(pool, avl_pool *, uint32_t, avl_pool_link)
+
+/**
+ * Insert a value on the tree of the pool.
+ * Same walk and retracing as insertAVLNode, with the links kept as a parent
+ * index and a direction.
+ * @param *pool The pool of the tree.
+ * @param val The value to be inserted.
+ * @return True if sucess, False on duplicates or if the pool is full.
+ */
+bool insertAVLPool(avl_pool *pool, int val) {
+  avl_pool_link path[AVL_MAX_HEIGHT];
+  int depth = 0;
+
+  avl_pool_link link = {AVL_POOL_NULL, false};
+  uint32_t cur = pool->root;
+  while (cur != AVL_POOL_NULL) {
+    avl_pool_node *node = &pool->nodes[cur];
+    if (node->val == val)
+      return false;
+    path[depth++] = link;
+    link = (avl_pool_link){cur, node->val < val};
+    cur = node->val < val ? node->right : node->left;
+  }
+
+  // The array might move, so only indices are held across the allocation.
+  uint32_t index = allocPoolNode(pool, val);
+  if (index == AVL_POOL_NULL)
+    return false;
+  poolSetLink(pool, link, index);
+  pool->count++;
+
+  poolRetraceInsert(pool, path, depth);
+  return true;
+}
+
+/**
+ * Remove a value from the tree of the pool.
+ * Same walk and retracing as removeAVLNode, the node goes back to the free list.
+ * @param *pool The pool of the tree.
+ * @param val The value of the node to be deleted.
+ * @return True if removed, false otherwise.
+ */
+bool removeAVLPool(avl_pool *pool, int val) {
+  avl_pool_link path[AVL_MAX_HEIGHT];
+  int depth = 0;
+
+  avl_pool_link link = {AVL_POOL_NULL, false};
+  uint32_t cur = pool->root;
+  while (cur != AVL_POOL_NULL && pool->nodes[cur].val != val) {
+    path[depth++] = link;
+    link = (avl_pool_link){cur, pool->nodes[cur].val < val};
+    cur = pool->nodes[cur].val < val ? pool->nodes[cur].right : pool->nodes[cur].left;
+  }
+  if (cur == AVL_POOL_NULL)
+    return false;
+
+  avl_pool_node *toRemove = &pool->nodes[cur];
+  uint32_t freed = cur;
+  if (toRemove->left != AVL_POOL_NULL && toRemove->right != AVL_POOL_NULL) {
+    // Walk to the successor, copy its value and unlink it instead.
+    path[depth++] = link;
+    link = (avl_pool_link){cur, true};
+    freed = toRemove->right;
+    while (pool->nodes[freed].left != AVL_POOL_NULL) {
+      path[depth++] = link;
+      link = (avl_pool_link){freed, false};
+      freed = pool->nodes[freed].left;
+    }
+    toRemove->val = pool->nodes[freed].val;
+    poolSetLink(pool, link, pool->nodes[freed].right);
+  } else {
+    poolSetLink(pool, link, toRemove->left != AVL_POOL_NULL ? toRemove->left : toRemove->right);
+  }
+  freePoolNode(pool, freed);
+  pool->count--;
+
+  poolRetraceRemove(pool, path, depth);
+  return true;
+}
+
+/**
+ * Search for a value on the tree of the pool.
+ * @param *pool The pool of the tree.
+ * @param val The value to be searched.
+ * @return True if found, else False.
+ */
+bool searchAVLPool(avl_pool *pool, int val) {
+  uint32_t cur = pool->root;
+  while (cur != AVL_POOL_NULL) {
+    if (pool->nodes[cur].val == val)
+      return true;
+    cur = pool->nodes[cur].val < val ? pool->nodes[cur].right : pool->nodes[cur].left;
+  }
+  return false;
+}
+
+/**
+ * Empty the tree in O(1), the array is kept for the next inserts.
+ * @param *pool The pool to reset.
+ */
+void resetAVLPool(avl_pool *pool) {
+  pool->used = 1;
+  pool->freeList = AVL_POOL_NULL;
+  pool->root = AVL_POOL_NULL;
+  pool->count = 0;
+}
+
+/**
+ * Free the array of the pool.
+ * @param *pool The pool to cleanup.
+ */
+void cleanupAVLPool(avl_pool *pool) {
+  free(pool->nodes);
+  pool->nodes = NULL;
+  pool->capacity = 0;
+  resetAVLPool(pool);
+}
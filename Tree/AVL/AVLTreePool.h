@@ -0,0 +1,41 @@
+#ifndef AVL_TREE_POOL_H
+#define AVL_TREE_POOL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// @brief Index of the empty tree, slot 0 of the pool is never used.
+#define AVL_POOL_NULL 0
+
+/// @brief Most nodes a pool can hold, the right index has 26 bits.
+#define AVL_POOL_MAX_NODES ((1u << 26) - 1)
+
+/// @brief AVL node addressed by its index on the pool, 12 bytes.
+/// The height fits in 6 bits, so it shares a word with the right index.
+typedef struct AvlPoolNode {
+  int val;
+  uint32_t left;
+  uint32_t right : 26;
+  uint32_t height : 6;
+} avl_pool_node;
+
+/// @brief AVL tree whose nodes live in one growable array.
+/// Freed nodes are chained on freeList through their left index.
+typedef struct AvlPool {
+  avl_pool_node *nodes;
+  uint32_t capacity;
+  uint32_t used;
+  uint32_t freeList;
+  uint32_t root;
+  uint32_t count;
+} avl_pool;
+
+bool initAVLPool(avl_pool *pool, uint32_t capacity);
+bool insertAVLPool(avl_pool *pool, int val);
+bool removeAVLPool(avl_pool *pool, int val);
+bool searchAVLPool(avl_pool *pool, int val);
+
+void resetAVLPool(avl_pool *pool);
+void cleanupAVLPool(avl_pool *pool);
+
+#endif
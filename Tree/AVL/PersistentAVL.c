@@ -0,0 +1,334 @@
+#include "PersistentAVL.h"
+#include <stdlib.h>
+#define getMax(x, y) ((x) > (y) ? (x) : (y))
+
+/// @brief Outcome of a path copy.
+enum { PAVL_FAILED = -1, PAVL_UNCHANGED = 0, PAVL_CHANGED = 1 };
+
+/**
+ * Get the height of a node, 0 for an empty tree.
+ */
+static int heightOf(const pavl_node *node) {
+  return node != NULL ? node->height : 0;
+}
+
+/**
+ * Take a new reference to a node.
+ * @return The same node.
+ */
+static pavl_node *retain(pavl_node *node) {
+  if (node != NULL)
+    atomic_fetch_add_explicit(&node->refs, 1, memory_order_relaxed);
+  return node;
+}
+
+/**
+ * Drop a reference to a node, like a snapshot from acquirePersistentAVL.
+ * The last reference frees the node and drops its children, the left side
+ * recurses and the right side loops so the depth is bounded by the height.
+ * @param *node The node, may be NULL.
+ */
+void releasePersistentAVL(pavl_node *node) {
+  while (node != NULL && atomic_fetch_sub_explicit(&node->refs, 1, memory_order_acq_rel) == 1) {
+    pavl_node *right = node->right;
+    releasePersistentAVL(node->left);
+    free(node);
+    node = right;
+  }
+}
+
+/**
+ * Allocate a node that owns the passed references to its children.
+ * On fail the references are dropped.
+ * @return The new node with one reference, NULL if fail.
+ */
+static pavl_node *makeNode(int val, pavl_node *left, pavl_node *right) {
+  pavl_node *new = malloc(sizeof(pavl_node));
+  if (new == NULL) {
+    releasePersistentAVL(left);
+    releasePersistentAVL(right);
+    return NULL;
+  }
+  new->val = val;
+  new->height = 1 + getMax(heightOf(left), heightOf(right));
+  atomic_init(&new->refs, 1);
+  new->left = left;
+  new->right = right;
+  return new;
+}
+
+/**
+ * Build a balanced node from owned children whose heights differ by at most 2.
+ * Rotations copy the child they open instead of changing it.
+ * @return The new subtree, NULL if fail.
+ */
+static pavl_node *balance(int val, pavl_node *left, pavl_node *right) {
+  if (heightOf(left) > heightOf(right) + 1) {
+    pavl_node *child = left;
+    pavl_node *node;
+    if (heightOf(child->left) >= heightOf(child->right)) {
+      // Left Left Case.
+      node = makeNode(val, retain(child->right), right);
+      node = node ? makeNode(child->val, retain(child->left), node) : NULL;
+    } else {
+      // Left Right Case.
+      pavl_node *pivot = child->right;
+      node = makeNode(val, retain(pivot->right), right);
+      pavl_node *inner = node ? makeNode(child->val, retain(child->left), retain(pivot->left)) : NULL;
+      if (inner == NULL)
+        releasePersistentAVL(node);
+      node = inner ? makeNode(pivot->val, inner, node) : NULL;
+    }
+    releasePersistentAVL(child);
+    return node;
+  }
+
+  if (heightOf(right) > heightOf(left) + 1) {
+    pavl_node *child = right;
+    pavl_node *node;
+    if (heightOf(child->right) >= heightOf(child->left)) {
+      // Right Right Case.
+      node = makeNode(val, left, retain(child->left));
+      node = node ? makeNode(child->val, node, retain(child->right)) : NULL;
+    } else {
+      // Right Left Case.
+      pavl_node *pivot = child->left;
+      node = makeNode(val, left, retain(pivot->left));
+      pavl_node *inner = node ? makeNode(child->val, retain(pivot->right), retain(child->right)) : NULL;
+      if (inner == NULL)
+        releasePersistentAVL(node);
+      node = inner ? makeNode(pivot->val, node, inner) : NULL;
+    }
+    releasePersistentAVL(child);
+    return node;
+  }
+
+  return makeNode(val, left, right);
+}
+
+/**
+ * Copy the path to val with val inserted.
+ * @param *status Set to PAVL_CHANGED, PAVL_UNCHANGED on duplicates or PAVL_FAILED.
+ * @return The new subtree when changed, else NULL.
+ */
+static pavl_node *insertPath(pavl_node *node, int val, int *status) {
+  if (node == NULL) {
+    pavl_node *new = makeNode(val, NULL, NULL);
+    *status = new != NULL ? PAVL_CHANGED : PAVL_FAILED;
+    return new;
+  }
+  if (node->val == val) {
+    *status = PAVL_UNCHANGED;
+    return NULL;
+  }
+
+  pavl_node *new;
+  if (node->val > val) {
+    pavl_node *left = insertPath(node->left, val, status);
+    if (*status != PAVL_CHANGED)
+      return NULL;
+    new = balance(node->val, left, retain(node->right));
+  } else {
+    pavl_node *right = insertPath(node->right, val, status);
+    if (*status != PAVL_CHANGED)
+      return NULL;
+    new = balance(node->val, retain(node->left), right);
+  }
+  if (new == NULL)
+    *status = PAVL_FAILED;
+  return new;
+}
+
+/**
+ * Copy the path to val with val removed.
+ * @param *status Set to PAVL_CHANGED, PAVL_UNCHANGED when missing or PAVL_FAILED.
+ * @return The new subtree when changed, which may be empty.
+ */
+static pavl_node *removePath(pavl_node *node, int val, int *status) {
+  if (node == NULL) {
+    *status = PAVL_UNCHANGED;
+    return NULL;
+  }
+
+  pavl_node *new;
+  if (node->val > val) {
+    pavl_node *left = removePath(node->left, val, status);
+    if (*status != PAVL_CHANGED)
+      return NULL;
+    new = balance(node->val, left, retain(node->right));
+  } else if (node->val < val) {
+    pavl_node *right = removePath(node->right, val, status);
+    if (*status != PAVL_CHANGED)
+      return NULL;
+    new = balance(node->val, retain(node->left), right);
+  } else {
+    *status = PAVL_CHANGED;
+    // Zero or one child, the child takes the place of the node.
+    if (node->left == NULL)
+      return retain(node->right);
+    if (node->right == NULL)
+      return retain(node->left);
+
+    // Two children, the successor takes the place of the node.
+    pavl_node *successor = node->right;
+    while (successor->left != NULL)
+      successor = successor->left;
+    pavl_node *right = removePath(node->right, successor->val, status);
+    if (*status != PAVL_CHANGED)
+      return NULL;
+    new = balance(successor->val, retain(node->left), right);
+  }
+  if (new == NULL)
+    *status = PAVL_FAILED;
+  return new;
+}
+
+/**
+ * Wait for every reader that could still see a retired root and drop them.
+ * The write lock must be held.
+ */
+static void reclaimRetired(persistent_avl *tree) {
+  if (tree->retiredCount == 0)
+    return;
+  epoch_synchronize(&tree->epoch);
+  for (int i = 0; i < tree->retiredCount; i++)
+    releasePersistentAVL(tree->retired[i]);
+  tree->retiredCount = 0;
+}
+
+/**
+ * Publish a new root and retire the old one.
+ * The write lock must be held.
+ */
+static void publishRoot(persistent_avl *tree, pavl_node *root) {
+  pavl_node *old = atomic_exchange_explicit(&tree->root, root, memory_order_acq_rel);
+  if (old == NULL)
+    return;
+  if (tree->retiredCount == PAVL_RETIRE_BATCH)
+    reclaimRetired(tree);
+  tree->retired[tree->retiredCount++] = old;
+}
+
+/**
+ * Initialize an empty tree.
+ * @param *tree The tree to initialize.
+ * @return True if sucess, else False.
+ */
+bool initPersistentAVL(persistent_avl *tree) {
+  atomic_init(&tree->root, NULL);
+  tree->count = 0;
+  tree->retiredCount = 0;
+  if (pthread_mutex_init(&tree->writeLock, NULL) != 0)
+    return false;
+  if (!init_epoch_domain(&tree->epoch)) {
+    pthread_mutex_destroy(&tree->writeLock);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Insert a value into a new version of the tree.
+ * Readers keep seeing the old version until the new root is published.
+ * @param *tree The tree.
+ * @param val The value to be inserted.
+ * @return True if inserted, false on duplicates or fail.
+ */
+bool insertPersistentAVL(persistent_avl *tree, int val) {
+  int status;
+  pthread_mutex_lock(&tree->writeLock);
+  pavl_node *root = atomic_load_explicit(&tree->root, memory_order_relaxed);
+  pavl_node *new = insertPath(root, val, &status);
+  if (status == PAVL_CHANGED) {
+    publishRoot(tree, new);
+    tree->count++;
+  }
+  pthread_mutex_unlock(&tree->writeLock);
+  return status == PAVL_CHANGED;
+}
+
+/**
+ * Remove a value from a new version of the tree.
+ * @param *tree The tree.
+ * @param val The value to be removed.
+ * @return True if removed, false if missing or fail.
+ */
+bool removePersistentAVL(persistent_avl *tree, int val) {
+  int status;
+  pthread_mutex_lock(&tree->writeLock);
+  pavl_node *root = atomic_load_explicit(&tree->root, memory_order_relaxed);
+  pavl_node *new = removePath(root, val, &status);
+  if (status == PAVL_CHANGED) {
+    publishRoot(tree, new);
+    tree->count--;
+  }
+  pthread_mutex_unlock(&tree->writeLock);
+  return status == PAVL_CHANGED;
+}
+
+/**
+ * Search a node in a version of the tree, no lock is taken.
+ * @param *root A root held by acquirePersistentAVL.
+ * @param val The value to be searched.
+ * @return The desired Node, NULL if not found.
+ */
+const pavl_node *searchPavlNode(const pavl_node *root, int val) {
+  while (root != NULL && root->val != val)
+    root = root->val > val ? root->left : root->right;
+  return root;
+}
+
+/**
+ * Check if the current version holds a value, without locks.
+ * @param *tree The tree.
+ * @param val The value to be searched.
+ * @return True if found, else False.
+ */
+bool searchPersistentAVL(persistent_avl *tree, int val) {
+  int token = epoch_enter(&tree->epoch);
+  const pavl_node *root = atomic_load_explicit(&tree->root, memory_order_acquire);
+  bool found = searchPavlNode(root, val) != NULL;
+  epoch_exit(&tree->epoch, token);
+  return found;
+}
+
+/**
+ * Take a snapshot of the current version.
+ * The snapshot never changes and stays valid until released, whatever the
+ * writers do, so it can be walked for as long as needed.
+ * @param *tree The tree.
+ * @return The root of the snapshot, NULL if the tree is empty.
+ */
+pavl_node *acquirePersistentAVL(persistent_avl *tree) {
+  // The epoch keeps the root alive until the reference is taken.
+  int token = epoch_enter(&tree->epoch);
+  pavl_node *root = retain(atomic_load_explicit(&tree->root, memory_order_acquire));
+  epoch_exit(&tree->epoch, token);
+  return root;
+}
+
+/**
+ * Free the old versions no reader can reach anymore, without waiting for a
+ * full batch. Waits for the readers running at the call.
+ * @param *tree The tree.
+ */
+void reclaimPersistentAVL(persistent_avl *tree) {
+  pthread_mutex_lock(&tree->writeLock);
+  reclaimRetired(tree);
+  pthread_mutex_unlock(&tree->writeLock);
+}
+
+/**
+ * Cleanup the Tree, no reader or writer may be active.
+ * Snapshots still held stay valid until released.
+ * @param *tree The tree.
+ */
+void cleanupPersistentAVL(persistent_avl *tree) {
+  for (int i = 0; i < tree->retiredCount; i++)
+    releasePersistentAVL(tree->retired[i]);
+  tree->retiredCount = 0;
+  releasePersistentAVL(atomic_exchange(&tree->root, NULL));
+  tree->count = 0;
+  pthread_mutex_destroy(&tree->writeLock);
+  cleanup_epoch_domain(&tree->epoch);
+}
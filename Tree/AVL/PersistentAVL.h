@@ -0,0 +1,51 @@
+#ifndef PERSISTENT_AVL_H
+#define PERSISTENT_AVL_H
+
+#include "../../Sync/Epoch.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+/// @brief Old roots a writer collects before it waits for the readers and
+/// frees them, so the wait is paid once per batch of updates.
+#define PAVL_RETIRE_BATCH 64
+
+/// @brief Immutable AVL node, shared by every version that reaches it.
+/// refs counts the parents and roots pointing to the node.
+typedef struct PersistentAvlNode
+{
+  int val;
+  int height;
+  _Atomic int refs;
+  struct PersistentAvlNode *left;
+  struct PersistentAvlNode *right;
+} pavl_node;
+
+/// @brief AVL where every update copies the path it changes into a new root
+/// that shares the untouched subtrees with the old one.
+/// Writers are serialized by writeLock, readers take no lock: they load the
+/// root inside an epoch section or hold a reference to it as a snapshot.
+typedef struct PersistentAvl
+{
+  _Atomic(pavl_node *) root;
+  int count;
+  pthread_mutex_t writeLock;
+  epoch_domain epoch;
+  pavl_node *retired[PAVL_RETIRE_BATCH];
+  int retiredCount;
+} persistent_avl;
+
+bool initPersistentAVL(persistent_avl *tree);
+
+bool insertPersistentAVL(persistent_avl *tree, int val);
+bool removePersistentAVL(persistent_avl *tree, int val);
+bool searchPersistentAVL(persistent_avl *tree, int val);
+
+pavl_node *acquirePersistentAVL(persistent_avl *tree);
+void releasePersistentAVL(pavl_node *root);
+const pavl_node *searchPavlNode(const pavl_node *root, int val);
+
+void reclaimPersistentAVL(persistent_avl *tree);
+void cleanupPersistentAVL(persistent_avl *tree);
+
+#endif
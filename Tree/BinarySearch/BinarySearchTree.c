@@ -155,6 +155,206 @@ bool removeBstNode(bst_node **root, int val) {
   }
 }
 
+/**
+ * Find the node of the smallest value not below val.
+ * @param *root The tree to be searched.
+ * @param val The bound.
+ * @return The node, NULL if every value is smaller than val.
+ */
+bst_node *lowerBoundBst(bst_node *root, int val) {
+  bst_node *bound = NULL;
+  while (root != NULL) {
+    if (root->val >= val) {
+      bound = root;
+      root = root->left;
+    } else {
+      root = root->right;
+    }
+  }
+  return bound;
+}
+
+/**
+ * Find the node of the smallest value above val.
+ * @param *root The tree to be searched.
+ * @param val The bound.
+ * @return The node, NULL if no value is bigger than val.
+ */
+bst_node *upperBoundBst(bst_node *root, int val) {
+  bst_node *bound = NULL;
+  while (root != NULL) {
+    if (root->val > val) {
+      bound = root;
+      root = root->left;
+    } else {
+      root = root->right;
+    }
+  }
+  return bound;
+}
+
+/**
+ * Initialize an empty cursor, the stack is allocated on first use.
+ * @param *cursor The cursor to initialize.
+ */
+void initBstCursor(bst_cursor *cursor) {
+  cursor->stack = NULL;
+  cursor->depth = 0;
+  cursor->capacity = 0;
+}
+
+/**
+ * Push a node on a cursor, doubling the stack when full.
+ * On allocation failure the cursor is left past the end.
+ * @return True if pushed, else False.
+ */
+static bool pushBstCursor(bst_cursor *cursor, bst_node *node) {
+  if (cursor->depth == cursor->capacity) {
+    int capacity = cursor->capacity > 0 ? cursor->capacity * 2 : 32;
+    bst_node **stack = realloc(cursor->stack, capacity * sizeof(bst_node *));
+    if (stack == NULL) {
+      cursor->depth = 0;
+      return false;
+    }
+    cursor->stack = stack;
+    cursor->capacity = capacity;
+  }
+  cursor->stack[cursor->depth++] = node;
+  return true;
+}
+
+/**
+ * Get the node on top of a cursor, NULL if past the end.
+ */
+static bst_node *topBstCursor(bst_cursor *cursor) {
+  return cursor->depth > 0 ? cursor->stack[cursor->depth - 1] : NULL;
+}
+
+/**
+ * Push a node and its leftmost descendants on a cursor.
+ * @return The leftmost node, NULL if the stack could not grow.
+ */
+static bst_node *pushLeftSpine(bst_cursor *cursor, bst_node *node) {
+  while (node != NULL) {
+    if (!pushBstCursor(cursor, node))
+      return NULL;
+    node = node->left;
+  }
+  return topBstCursor(cursor);
+}
+
+/**
+ * Position a cursor on the smallest value of a tree.
+ * @param *cursor The cursor to position.
+ * @param *root The tree to walk.
+ * @return The first node, NULL if the tree is empty.
+ */
+bst_node *beginBstCursor(bst_cursor *cursor, bst_node *root) {
+  cursor->depth = 0;
+  return pushLeftSpine(cursor, root);
+}
+
+/**
+ * Position a cursor on the smallest value not below val, like lowerBoundBst.
+ * @param *cursor The cursor to position.
+ * @param *root The tree to walk.
+ * @param val The bound.
+ * @return The node, NULL if every value is smaller than val.
+ */
+bst_node *seekBstCursor(bst_cursor *cursor, bst_node *root, int val) {
+  // The path to the bound is a prefix of the walked path, cut the rest.
+  int boundDepth = 0;
+  cursor->depth = 0;
+  while (root != NULL) {
+    if (!pushBstCursor(cursor, root))
+      return NULL;
+    if (root->val >= val) {
+      boundDepth = cursor->depth;
+      root = root->left;
+    } else {
+      root = root->right;
+    }
+  }
+  cursor->depth = boundDepth;
+  return topBstCursor(cursor);
+}
+
+/**
+ * Move a cursor to the next value in order.
+ * @param *cursor The cursor to move.
+ * @return The next node, NULL past the biggest value.
+ */
+bst_node *nextBstCursor(bst_cursor *cursor) {
+  bst_node *node = topBstCursor(cursor);
+  if (node == NULL)
+    return NULL;
+  if (node->right != NULL)
+    return pushLeftSpine(cursor, node->right);
+
+  // Climb until coming up from a left child.
+  bst_node *child = NULL;
+  do {
+    child = cursor->stack[--cursor->depth];
+  } while (cursor->depth > 0 && cursor->stack[cursor->depth - 1]->right == child);
+  return topBstCursor(cursor);
+}
+
+/**
+ * Move a cursor to the previous value in order.
+ * @param *cursor The cursor to move.
+ * @return The previous node, NULL before the smallest value.
+ */
+bst_node *prevBstCursor(bst_cursor *cursor) {
+  bst_node *node = topBstCursor(cursor);
+  if (node == NULL)
+    return NULL;
+  if (node->left != NULL) {
+    node = node->left;
+    while (node != NULL) {
+      if (!pushBstCursor(cursor, node))
+        return NULL;
+      node = node->right;
+    }
+    return topBstCursor(cursor);
+  }
+
+  // Climb until coming up from a right child.
+  bst_node *child = NULL;
+  do {
+    child = cursor->stack[--cursor->depth];
+  } while (cursor->depth > 0 && cursor->stack[cursor->depth - 1]->left == child);
+  return topBstCursor(cursor);
+}
+
+/**
+ * Copy the values from the cursor up to high into a buffer, one batch at a time.
+ * Seek the cursor to the low end of the range first and call again while the
+ * buffer comes back full, each call resumes after the last value copied.
+ * @param *cursor The cursor, left on the first value not copied.
+ * @param high The biggest value of the range.
+ * @param *out The buffer receiving the values in order.
+ * @param max The capacity of the buffer.
+ * @return The number of values copied.
+ */
+int scanBstRange(bst_cursor *cursor, int high, int *out, int max) {
+  int count = 0;
+  bst_node *node = topBstCursor(cursor);
+  while (node != NULL && count < max && node->val <= high) {
+    out[count++] = node->val;
+    node = nextBstCursor(cursor);
+  }
+  return count;
+}
+
+/**
+ * Free the stack of a cursor and leave it empty.
+ * @param *cursor The cursor to cleanup.
+ */
+void cleanupBstCursor(bst_cursor *cursor) {
+  free(cursor->stack);
+  initBstCursor(cursor);
+}
+
 /**
  * Cleanup the Tree.
  * Sets the root to NULL after cleanup.
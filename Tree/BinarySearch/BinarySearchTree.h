@@ -9,6 +9,16 @@ typedef struct Node {
   struct Node *right;
 } bst_node;
 
+/// @brief In order position on a tree, the stack holds the path from the root
+/// down to the current node, which is on top. An empty stack is past the end.
+/// The stack grows with the tree, which has no height bound.
+/// The tree must not change while a cursor is in use.
+typedef struct BstCursor {
+  bst_node **stack;
+  int depth;
+  int capacity;
+} bst_cursor;
+
 bst_node *createBstNode(int val);
 bst_node *findMinBst(bst_node *root);
 bst_node *findMaxBst(bst_node *root);
@@ -17,6 +27,17 @@ bst_node *searchBstNode(bst_node *root, int val);
 bool removeBstNode(bst_node **root, int val);
 bool insertBstNode(bst_node **root, int val);
 
+bst_node *lowerBoundBst(bst_node *root, int val);
+bst_node *upperBoundBst(bst_node *root, int val);
+
+void initBstCursor(bst_cursor *cursor);
+bst_node *beginBstCursor(bst_cursor *cursor, bst_node *root);
+bst_node *seekBstCursor(bst_cursor *cursor, bst_node *root, int val);
+bst_node *nextBstCursor(bst_cursor *cursor);
+bst_node *prevBstCursor(bst_cursor *cursor);
+int scanBstRange(bst_cursor *cursor, int high, int *out, int max);
+void cleanupBstCursor(bst_cursor *cursor);
+
 void cleanupBst(bst_node **root);
 void inorderBstTraverse(bst_node *root);
 void preBstTraverse(bst_node *root);
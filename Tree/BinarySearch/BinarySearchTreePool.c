@@ -0,0 +1,155 @@
+#include "BinarySearchTreePool.h"
+#include <stdlib.h>
+
+/**
+ * Initialize a empty pool with room for capacity nodes.
+ * @param *pool The pool to initialize.
+ * @param capacity The nodes to allocate up front, the pool grows past it.
+ * @return True if allocated, else False.
+ */
+bool initBstPool(bst_pool *pool, uint32_t capacity) {
+  if (capacity < 1)
+    capacity = 1;
+  if (capacity >= UINT32_MAX / 2)
+    capacity = UINT32_MAX / 2 - 1;
+
+  // One more slot for the reserved index 0.
+  pool->nodes = malloc((size_t)(capacity + 1) * sizeof(bst_pool_node));
+  if (pool->nodes == NULL)
+    return false;
+  pool->capacity = capacity + 1;
+  resetBstPool(pool);
+  return true;
+}
+
+/**
+ * Take a node from the free list or the end of the array, doubling it when full.
+ * @param *pool The pool to allocate from.
+ * @param val The value of the node.
+ * @return The index of the node, BST_POOL_NULL if the pool can't grow.
+ */
+static uint32_t allocBstPoolNode(bst_pool *pool, int val) {
+  uint32_t index = pool->freeList;
+  if (index != BST_POOL_NULL) {
+    pool->freeList = pool->nodes[index].left;
+  } else {
+    if (pool->used == pool->capacity) {
+      if (pool->capacity >= UINT32_MAX / 2)
+        return BST_POOL_NULL;
+      bst_pool_node *nodes =
+          realloc(pool->nodes, (size_t)pool->capacity * 2 * sizeof(bst_pool_node));
+      if (nodes == NULL)
+        return BST_POOL_NULL;
+      pool->nodes = nodes;
+      pool->capacity *= 2;
+    }
+    index = pool->used++;
+  }
+
+  pool->nodes[index].val = val;
+  pool->nodes[index].left = BST_POOL_NULL;
+  pool->nodes[index].right = BST_POOL_NULL;
+  return index;
+}
+
+/**
+ * Insert a value on the tree of the pool.
+ * @param *pool The pool of the tree.
+ * @param val The value to be inserted.
+ * @return True if sucess, False on duplicates or if the pool is full.
+ */
+bool insertBstPool(bst_pool *pool, int val) {
+  // Find the link to fill, as a index and a side, since the array might move.
+  uint32_t parent = BST_POOL_NULL;
+  uint32_t cur = pool->root;
+  while (cur != BST_POOL_NULL) {
+    if (pool->nodes[cur].val == val)
+      return false;
+    parent = cur;
+    cur = pool->nodes[cur].val < val ? pool->nodes[cur].right : pool->nodes[cur].left;
+  }
+
+  uint32_t index = allocBstPoolNode(pool, val);
+  if (index == BST_POOL_NULL)
+    return false;
+  if (parent == BST_POOL_NULL)
+    pool->root = index;
+  else if (pool->nodes[parent].val < val)
+    pool->nodes[parent].right = index;
+  else
+    pool->nodes[parent].left = index;
+  pool->count++;
+  return true;
+}
+
+/**
+ * Remove a value from the tree of the pool.
+ * A node with two children takes the value of its successor, which is unlinked
+ * on the same walk. The freed node goes back to the free list.
+ * @param *pool The pool of the tree.
+ * @param val The value of the node to be deleted.
+ * @return True if removed, false otherwise.
+ */
+bool removeBstPool(bst_pool *pool, int val) {
+  uint32_t *link = &pool->root;
+  while (*link != BST_POOL_NULL && pool->nodes[*link].val != val)
+    link = pool->nodes[*link].val < val ? &pool->nodes[*link].right : &pool->nodes[*link].left;
+  if (*link == BST_POOL_NULL)
+    return false;
+
+  bst_pool_node *toRemove = &pool->nodes[*link];
+  uint32_t freed = *link;
+  if (toRemove->left != BST_POOL_NULL && toRemove->right != BST_POOL_NULL) {
+    link = &toRemove->right;
+    while (pool->nodes[*link].left != BST_POOL_NULL)
+      link = &pool->nodes[*link].left;
+    freed = *link;
+    toRemove->val = pool->nodes[freed].val;
+    *link = pool->nodes[freed].right;
+  } else {
+    *link = toRemove->left != BST_POOL_NULL ? toRemove->left : toRemove->right;
+  }
+
+  pool->nodes[freed].left = pool->freeList;
+  pool->freeList = freed;
+  pool->count--;
+  return true;
+}
+
+/**
+ * Search for a value on the tree of the pool.
+ * @param *pool The pool of the tree.
+ * @param val The value to be searched.
+ * @return True if found, else False.
+ */
+bool searchBstPool(bst_pool *pool, int val) {
+  uint32_t cur = pool->root;
+  while (cur != BST_POOL_NULL) {
+    if (pool->nodes[cur].val == val)
+      return true;
+    cur = pool->nodes[cur].val < val ? pool->nodes[cur].right : pool->nodes[cur].left;
+  }
+  return false;
+}
+
+/**
+ * Empty the tree in O(1), the array is kept for the next inserts.
+ * @param *pool The pool to reset.
+ */
+void resetBstPool(bst_pool *pool) {
+  pool->used = 1;
+  pool->freeList = BST_POOL_NULL;
+  pool->root = BST_POOL_NULL;
+  pool->count = 0;
+}
+
+/**
+ * Free the array of the pool.
+ * @param *pool The pool to cleanup.
+ */
+void cleanupBstPool(bst_pool *pool) {
+  free(pool->nodes);
+  pool->nodes = NULL;
+  pool->capacity = 0;
+  resetBstPool(pool);
+}
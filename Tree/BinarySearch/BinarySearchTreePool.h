@@ -0,0 +1,35 @@
+#ifndef BINARY_SEARCH_TREE_POOL_H
+#define BINARY_SEARCH_TREE_POOL_H
+#include <stdbool.h>
+#include <stdint.h>
+
+/// @brief Index of the empty tree, slot 0 of the pool is never used.
+#define BST_POOL_NULL 0
+
+/// @brief BST node addressed by its index on the pool, 12 bytes.
+typedef struct BstPoolNode {
+  int val;
+  uint32_t left;
+  uint32_t right;
+} bst_pool_node;
+
+/// @brief Binary Search Tree whose nodes live in one growable array.
+/// Freed nodes are chained on freeList through their left index.
+typedef struct BstPool {
+  bst_pool_node *nodes;
+  uint32_t capacity;
+  uint32_t used;
+  uint32_t freeList;
+  uint32_t root;
+  uint32_t count;
+} bst_pool;
+
+bool initBstPool(bst_pool *pool, uint32_t capacity);
+bool insertBstPool(bst_pool *pool, int val);
+bool removeBstPool(bst_pool *pool, int val);
+bool searchBstPool(bst_pool *pool, int val);
+
+void resetBstPool(bst_pool *pool);
+void cleanupBstPool(bst_pool *pool);
+
+#endif
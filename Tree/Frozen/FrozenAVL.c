@@ -0,0 +1,26 @@
+#include "FrozenAVL.h"
+#include <stdlib.h>
+
+/**
+ * Copy a tree into a read only frozen tree in O(n).
+ * The frozen tree doesn't follow later changes, freeze again to publish them.
+ * @param *root The tree to be copied.
+ * @return The frozen tree, NULL if fail.
+ */
+frozen_tree *frozenFromAVL(avl_node *root) {
+  avl_cursor cursor;
+  int count = 0;
+  for (avl_node *node = beginAVLCursor(&cursor, root); node != NULL; node = nextAVLCursor(&cursor))
+    count++;
+
+  int *vals = malloc((count > 0 ? count : 1) * sizeof(int));
+  if (vals == NULL)
+    return NULL;
+  count = 0;
+  for (avl_node *node = beginAVLCursor(&cursor, root); node != NULL; node = nextAVLCursor(&cursor))
+    vals[count++] = node->val;
+
+  frozen_tree *tree = buildFrozenTree(vals, count);
+  free(vals);
+  return tree;
+}
@@ -0,0 +1,9 @@
+#ifndef FROZEN_AVL_H
+#define FROZEN_AVL_H
+
+#include "../AVL/AVLTree.h"
+#include "FrozenTree.h"
+
+frozen_tree *frozenFromAVL(avl_node *root);
+
+#endif
@@ -0,0 +1,39 @@
+#include "FrozenBst.h"
+#include <stdlib.h>
+
+/**
+ * Copy a tree into a read only frozen tree in O(n).
+ * The frozen tree doesn't follow later changes, freeze again to publish them.
+ * @param *root The tree to be copied.
+ * @return The frozen tree, NULL if fail.
+ */
+frozen_tree *frozenFromBst(bst_node *root) {
+  bst_cursor cursor;
+  initBstCursor(&cursor);
+  int count = 0;
+  int capacity = 64;
+  int *vals = malloc(capacity * sizeof(int));
+  bst_node *last = NULL;
+  for (bst_node *node = beginBstCursor(&cursor, root); node != NULL && vals != NULL; node = nextBstCursor(&cursor)) {
+    if (count == capacity) {
+      capacity *= 2;
+      int *grown = realloc(vals, capacity * sizeof(int));
+      if (grown == NULL)
+        free(vals);
+      vals = grown;
+      if (vals == NULL)
+        break;
+    }
+    vals[count++] = node->val;
+    last = node;
+  }
+  cleanupBstCursor(&cursor);
+
+  // A cursor that failed to grow ends before the biggest value, don't freeze
+  // a partial tree.
+  frozen_tree *tree = NULL;
+  if (vals != NULL && last == findMaxBst(root))
+    tree = buildFrozenTree(vals, count);
+  free(vals);
+  return tree;
+}
@@ -0,0 +1,9 @@
+#ifndef FROZEN_BST_H
+#define FROZEN_BST_H
+
+#include "../BinarySearch/BinarySearchTree.h"
+#include "FrozenTree.h"
+
+frozen_tree *frozenFromBst(bst_node *root);
+
+#endif
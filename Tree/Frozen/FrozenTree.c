@@ -0,0 +1,184 @@
+#include "FrozenTree.h"
+#include <limits.h>
+#include <stdlib.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Get the block a search continues on.
+ * @param block The current block.
+ * @param i The count of keys of the current block smaller than the value.
+ */
+static long childBlock(long block, int i) {
+  return block * (FROZEN_BLOCK + 1) + i + 1;
+}
+
+/**
+ * Count the keys of a block smaller than val, without branches.
+ * The keys are sorted, so this is also the index of the first key not below val.
+ */
+static int rankInBlock(const int *keys, int val) {
+#if defined(__SSE2__)
+  __m128i x = _mm_set1_epi32(val);
+  __m128i a = _mm_cmpgt_epi32(x, _mm_load_si128((const __m128i *)keys));
+  __m128i b = _mm_cmpgt_epi32(x, _mm_load_si128((const __m128i *)(keys + 4)));
+  __m128i c = _mm_cmpgt_epi32(x, _mm_load_si128((const __m128i *)(keys + 8)));
+  __m128i d = _mm_cmpgt_epi32(x, _mm_load_si128((const __m128i *)(keys + 12)));
+  // Narrow the 16 lane masks to bytes so one movemask reads them all.
+  __m128i bytes = _mm_packs_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+  return __builtin_popcount((unsigned)_mm_movemask_epi8(bytes));
+#else
+  int rank = 0;
+  for (int i = 0; i < FROZEN_BLOCK; i++)
+    rank += keys[i] < val;
+  return rank;
+#endif
+}
+
+/**
+ * Fill the blocks under block in order from the sorted values.
+ * Keys past the last value are padded with INT_MAX so they sort last.
+ * @param *next The index of the next value to place.
+ */
+static void fillBlocks(frozen_tree *tree, const int *vals, int *next, long block) {
+  if (block >= tree->blockCount)
+    return;
+  for (int i = 0; i < FROZEN_BLOCK; i++) {
+    fillBlocks(tree, vals, next, childBlock(block, i));
+    tree->blocks[block][i] = *next < tree->count ? vals[(*next)++] : INT_MAX;
+  }
+  fillBlocks(tree, vals, next, childBlock(block, FROZEN_BLOCK));
+}
+
+/**
+ * Build a frozen tree from values sorted in ascending order, in O(n).
+ * The values are copied, the array can be freed after.
+ * @param *vals The sorted values, without duplicates.
+ * @param count The number of values.
+ * @return The new tree, NULL if fail.
+ */
+frozen_tree *buildFrozenTree(const int *vals, int count) {
+  if (count < 0 || (count > 0 && vals == NULL))
+    return NULL;
+  frozen_tree *tree = malloc(sizeof(frozen_tree));
+  if (tree == NULL)
+    return NULL;
+
+  tree->count = count;
+  tree->blockCount = (count + FROZEN_BLOCK - 1) / FROZEN_BLOCK;
+  tree->max = count > 0 ? vals[count - 1] : INT_MIN;
+  tree->blocks = NULL;
+  if (count == 0)
+    return tree;
+
+  // Align every block on a cache line, a search reads one line per level.
+  tree->blocks = aligned_alloc(sizeof(tree->blocks[0]), tree->blockCount * sizeof(tree->blocks[0]));
+  if (tree->blocks == NULL) {
+    free(tree);
+    return NULL;
+  }
+  int next = 0;
+  fillBlocks(tree, vals, &next, 0);
+  return tree;
+}
+
+/**
+ * Find the smallest value not below val.
+ * @param *tree The tree to be searched.
+ * @param val The bound.
+ * @param *result Receives the value if found.
+ * @return True if found, false if every value is smaller than val.
+ */
+bool lowerBoundFrozen(const frozen_tree *tree, int val, int *result) {
+  // Past the biggest value only the INT_MAX padding would match.
+  if (tree == NULL || tree->count == 0 || val > tree->max)
+    return false;
+
+  int bound = INT_MAX;
+  for (long block = 0; block < tree->blockCount;) {
+    int i = rankInBlock(tree->blocks[block], val);
+    // A key found deeper is always smaller, keep the last one.
+    if (i < FROZEN_BLOCK)
+      bound = tree->blocks[block][i];
+    block = childBlock(block, i);
+  }
+  *result = bound;
+  return true;
+}
+
+/**
+ * Check if a value is in the tree.
+ * @param *tree The tree to be searched.
+ * @param val The value to be searched.
+ * @return True if found, else False.
+ */
+bool searchFrozen(const frozen_tree *tree, int val) {
+  int bound;
+  return lowerBoundFrozen(tree, val, &bound) && bound == val;
+}
+
+/**
+ * Find the lower bound of many values, FROZEN_BATCH at a time.
+ * The batch walks down one level per round and prefetches the next block of
+ * every lookup, so their cache misses are served in parallel.
+ * @param *tree The tree to be searched.
+ * @param *vals The values to look up.
+ * @param count The number of values.
+ * @param *results Receives the lower bound of each value.
+ * @param *found Receives if each lower bound exists, if not the result holds an unspecified value.
+ * @return The number of values that have a lower bound.
+ */
+int lowerBoundFrozenBatch(const frozen_tree *tree, const int *vals, int count, int *results, bool *found) {
+  int hits = 0;
+  if (tree == NULL || tree->count == 0) {
+    for (int i = 0; i < count; i++)
+      found[i] = false;
+    return 0;
+  }
+
+  long blocks[FROZEN_BATCH];
+  for (int start = 0; start < count; start += FROZEN_BATCH) {
+    int size = count - start < FROZEN_BATCH ? count - start : FROZEN_BATCH;
+    for (int j = 0; j < size; j++) {
+      blocks[j] = 0;
+      results[start + j] = INT_MAX;
+    }
+
+    // Walk down while any lookup of the batch is still inside the tree.
+    for (int alive = size; alive > 0;) {
+      alive = 0;
+      for (int j = 0; j < size; j++) {
+        if (blocks[j] >= tree->blockCount)
+          continue;
+        int i = rankInBlock(tree->blocks[blocks[j]], vals[start + j]);
+        if (i < FROZEN_BLOCK)
+          results[start + j] = tree->blocks[blocks[j]][i];
+        blocks[j] = childBlock(blocks[j], i);
+        if (blocks[j] < tree->blockCount) {
+          __builtin_prefetch(tree->blocks[blocks[j]]);
+          alive++;
+        }
+      }
+    }
+
+    for (int j = 0; j < size; j++) {
+      found[start + j] = vals[start + j] <= tree->max;
+      hits += found[start + j];
+    }
+  }
+  return hits;
+}
+
+/**
+ * Cleanup the Tree.
+ * Sets the tree to NULL after cleanup.
+ * @param **tree A pointer to the tree.
+ */
+void cleanupFrozenTree(frozen_tree **tree) {
+  if (tree == NULL || *tree == NULL)
+    return;
+  free((*tree)->blocks);
+  free(*tree);
+  *tree = NULL;
+}
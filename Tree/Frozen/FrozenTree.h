@@ -0,0 +1,33 @@
+#ifndef FROZEN_TREE_H
+#define FROZEN_TREE_H
+
+#include <stdbool.h>
+
+/// @brief Keys of a block, 16 ints fill one cache line.
+#define FROZEN_BLOCK 16
+
+/// @brief Lookups a batch walks down the tree together, so the block loads of
+/// one query overlap the compares of the others.
+#define FROZEN_BATCH 16
+
+/// @brief Immutable sorted set in the static B-tree (S-tree) layout.
+/// Every block holds FROZEN_BLOCK sorted keys and the children of block k are
+/// the blocks k * (FROZEN_BLOCK + 1) + i + 1, so there are no pointers to
+/// follow and every level is a single cache line.
+typedef struct FrozenTree
+{
+  int (*blocks)[FROZEN_BLOCK];
+  int blockCount;
+  int count;
+  int max;
+} frozen_tree;
+
+frozen_tree *buildFrozenTree(const int *vals, int count);
+
+bool lowerBoundFrozen(const frozen_tree *tree, int val, int *result);
+bool searchFrozen(const frozen_tree *tree, int val);
+int lowerBoundFrozenBatch(const frozen_tree *tree, const int *vals, int count, int *results, bool *found);
+
+void cleanupFrozenTree(frozen_tree **tree);
+
+#endif